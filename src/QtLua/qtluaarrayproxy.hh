@@ -25,6 +25,7 @@
 
 #include "qtluauserdata.hh"
 #include "qtluaiterator.hh"
+#include "qtluarangemethod.hh"
 
 namespace QtLua {
 
@@ -57,6 +58,7 @@ public:
   Value meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b);
   Value meta_index(State *ls, const Value &key);
   bool meta_contains(State *ls, const Value &key);
+  bool meta_try_index(State *ls, const Value &key, Value &value);
   Ref<Iterator> new_iterator(State *ls);
   bool support(Value::Operation c) const;
 
@@ -64,6 +66,13 @@ private:
   void completion_patch(String &path, String &entry, int &offset);
   String get_type_name() const;
 
+  friend class RangeMethod<ArrayProxyRo>;
+  int range_size() const;
+  int range_max_size() const;
+  void range_get(State *ls, Value::List &list, int offset, int count) const;
+  void range_push(lua_State *st, State *ls, int offset, int count) const;
+  Value range_table(State *ls, int offset, int count) const;
+
   /**
    * @short ArrayProxyRo iterator class
    * @internal
@@ -80,6 +89,7 @@ private:
     Value get_key() const;
     Value get_value() const;
     ValueRef get_value_ref();
+    int push_next(lua_State *st);
 
     QPointer<State> _ls;
     Ref<ArrayProxyRo> _proxy;
@@ -111,6 +121,13 @@ protected:
    * Lua operator @tt # returns the array size. Lua
    * operator @tt - returns a lua table copy of the container.
    *
+   * Ranges of elements can be accessed in a single call: @tt{p:get(i
+   * [, n])} returns up to @tt n elements starting at index @tt i as
+   * multiple values, @tt{p:set(i, table)} writes table elements
+   * starting at index @tt i and @tt{p:slice(i [, j])} returns a lua
+   * table copy of a sub range with the same index conventions as the
+   * lua @tt{string.sub} function.
+   *
    * The following example show how anarray can be
    * accessed from both C++ and lua script directly:
    *
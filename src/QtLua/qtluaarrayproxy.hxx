@@ -23,6 +23,7 @@
 
 #include "qtluauserdata.hxx"
 #include "qtluaiterator.hxx"
+#include "qtluarangemethod.hxx"
 
 namespace QtLua {
 
@@ -68,10 +69,13 @@ namespace QtLua {
   template <class T>
   Value ArrayProxyRo<T>::meta_index(State *ls, const Value &key)
   { 
+    if (RangeMethod<ArrayProxyRo> *m = RangeMethod<ArrayProxyRo>::get(key))
+      return Value(ls, m);
+
     if (!_array)
       return Value(ls);
 
-    unsigned int index = (unsigned int)key.to_number() - 1;
+    unsigned int index = (unsigned int)key.to_integer() - 1;
 
     if (index < _size)
       return Value(ls, _array[index]);
@@ -83,7 +87,7 @@ namespace QtLua {
   bool ArrayProxyRo<T>::meta_contains(State *ls, const Value &key)
   {
     try {
-      unsigned int index = (unsigned int)key.to_number() - 1;
+      unsigned int index = (unsigned int)key.to_integer() - 1;
 
       return index < _size;
     } catch (String &e) {
@@ -91,6 +95,27 @@ namespace QtLua {
     }
   }
 
+  template <class T>
+  bool ArrayProxyRo<T>::meta_try_index(State *ls, const Value &key, Value &value)
+  {
+    if (!_array)
+      return false;
+
+    unsigned int index;
+
+    try {
+      index = (unsigned int)key.to_integer() - 1;
+    } catch (String &e) {
+      return false;
+    }
+
+    if (index >= _size)
+      return false;
+
+    value = Value(ls, _array[index]);
+    return true;
+  }
+
   template <class T>
   Value ArrayProxyRo<T>::meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b)
   {
@@ -148,7 +173,7 @@ namespace QtLua {
     if (!_array)
       QTLUA_THROW(QtLua::ArrayProxy, "Can not index a null array.");
 
-    unsigned int index = (unsigned int)key.to_number() - 1;
+    unsigned int index = (unsigned int)key.to_integer() - 1;
 
     if (index >= _size)
       QTLUA_THROW(QtLua::ArrayProxy, "Array index `%' is out of bounds.", .arg(index));
@@ -200,7 +225,51 @@ namespace QtLua {
   template <class T>
   ValueRef ArrayProxyRo<T>::ProxyIterator::get_value_ref()
   {
-    return ValueRef(Value(_ls, _proxy), Value(_ls, (double)_it + 1));
+    return ValueRef(Value(_ls, _proxy), Value(_ls, (int)_it + 1));
+  }
+
+  template <class T>
+  int ArrayProxyRo<T>::ProxyIterator::push_next(lua_State *st)
+  {
+    if (!more())
+      return 0;
+
+    push(st, _ls, (int)_it + 1);
+    push(st, _ls, _proxy->_array[_it]);
+    _it++;
+    return 2;
+  }
+
+  template <class T>
+  int ArrayProxyRo<T>::range_size() const
+  {
+    return _array ? (int)_size : 0;
+  }
+
+  template <class T>
+  int ArrayProxyRo<T>::range_max_size() const
+  {
+    return range_size();
+  }
+
+  template <class T>
+  void ArrayProxyRo<T>::range_get(State *ls, Value::List &list, int offset, int count) const
+  {
+    for (int i = 0; i < count; i++)
+      list.append(Value(ls, _array[offset + i]));
+  }
+
+  template <class T>
+  void ArrayProxyRo<T>::range_push(lua_State *st, State *ls, int offset, int count) const
+  {
+    for (int i = 0; i < count; i++)
+      Iterator::push(st, ls, _array[offset + i]);
+  }
+
+  template <class T>
+  Value ArrayProxyRo<T>::range_table(State *ls, int offset, int count) const
+  {
+    return Value(ls, (unsigned int)count, _array + offset);
   }
 
   template <class T>
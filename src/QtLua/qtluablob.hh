@@ -0,0 +1,98 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008-2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+#ifndef QTLUABLOB_HH_
+#define QTLUABLOB_HH_
+
+#include <QByteArray>
+
+#include "qtluauserdata.hh"
+#include "qtluavalue.hh"
+
+namespace QtLua {
+
+  /**
+   * @short Shared binary buffer userdata
+   * @header QtLua/Blob
+   * @module {Base}
+   *
+   * This class exposes a @ref QByteArray to lua without copying its
+   * content in a lua string. The implicitly shared storage of the
+   * @ref QByteArray is kept by the @ref Blob object and sub ranges of
+   * a blob share the same storage too.
+   *
+   * The following operations are available from lua:
+   * @list
+   *   @item @tt{#blob} returns the length in bytes,
+   *   @item @tt{blob[i]} returns the byte value at index @tt i starting at 1,
+   *   @item @tt{blob:sub(i [, j])} returns a view of a sub range with the
+   *     same index conventions as the lua @tt{string.sub} function,
+   *   @item @tt{blob:find(str [, init])} returns the index of the first
+   *     occurrence of the string or @tt nil,
+   *   @item @tt{blob:tostring([i [, j]])} copies the content in a lua string.
+   * @end list
+   *
+   * Conversion of @ref QByteArray values to @ref Blob objects instead of
+   * lua strings can be enabled with the @ref State::enable_bytearray_blob
+   * function. @ref Blob objects are accepted back where a @ref QByteArray
+   * is expected without copying the data.
+   */
+  class Blob : public UserData
+  {
+  public:
+    QTLUA_REFTYPE(Blob);
+
+    /** Create a blob sharing storage of the given byte array */
+    Blob(const QByteArray &data);
+
+    /** Create a blob sharing storage of the given byte array and
+	exposing the @tt size bytes at @tt offset. */
+    Blob(const QByteArray &data, int offset, int size);
+
+    /** @This returns a @ref QByteArray with blob content. No copy
+	is performed when the blob exposes the whole underlying array. */
+    inline QByteArray get_bytearray() const;
+
+    /** @This returns a pointer to the blob first byte */
+    inline const char * data() const;
+
+    /** @This returns the blob size in bytes */
+    inline int size() const;
+
+    /** @This returns a new blob sharing storage with this blob and
+	exposing @tt size bytes at @tt offset. */
+    ptr sub(int offset, int size) const;
+
+  private:
+    Value meta_index(State *ls, const Value &key);
+    Value meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b);
+    bool support(Value::Operation c) const;
+    String get_value_str() const;
+
+    QByteArray _data;
+    int _offset;
+    int _size;
+  };
+
+}
+
+#endif
+
@@ -21,8 +21,11 @@
 #ifndef QTLUADISPATCHPROXY_HH_
 #define QTLUADISPATCHPROXY_HH_
 
+#include <QHash>
+
 #include "qtluauserdata.hh"
 #include "qtluaiterator.hh"
+#include "qtluastring.hh"
 
 namespace QtLua {
 
@@ -70,7 +73,10 @@ public:
    * feature is used, a reimplementation of the @ref
    * UserData::meta_contains function must be available in the same class
    * if either the @ref UserData::meta_index function or the @ref
-   * UserData::meta_newindex function is reimplemented.
+   * UserData::meta_newindex function is reimplemented. When the
+   * @ref UserData::meta_try_index function is not reimplemented by
+   * the class, the @ref UserData::meta_contains and @ref
+   * UserData::meta_index functions of the class are used instead.
    */
   template <class T>
   unsigned int add_target(T *t, Value::Operations mask = Value::OpAll,
@@ -91,6 +97,25 @@ public:
   template <class T>
   void remove_target(T *t);
 
+  /**
+   * This function enables caching of the target object used to read
+   * entries with string keys. When enabled, the object which provided
+   * an entry is probed first on next read access with the same key.
+   *
+   * The cache is cleared when targets are added or removed and
+   * entries are dropped on write access through this
+   * object. The @ref invalidate_route_cache function must be called
+   * if entries are added to an underlying object by other means and
+   * shadow entries of a following object.
+   */
+  void enable_route_cache(bool enabled = true);
+
+  /** @This returns true if route caching is enabled. */
+  inline bool is_route_cache_enabled() const;
+
+  /** @This clears the route cache. */
+  inline void invalidate_route_cache();
+
   /** 
    * This function handles the requested operation by relying on the
    * first registered object which @ref UserData::support {supports}
@@ -169,6 +194,7 @@ private:
     virtual Value _meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b) const = 0;
     virtual Value _meta_index(State *ls, const Value &key) const = 0;
     virtual bool _meta_contains(State *ls, const Value &key) const = 0;
+    virtual bool _meta_try_index(State *ls, const Value &key, Value &value) const = 0;
     virtual void _meta_newindex(State *ls, const Value &key, const Value &value) const = 0;
     virtual Value::List _meta_call(State *ls, const Value::List &args) const = 0;
     virtual Ref<Iterator> _new_iterator(State *ls) const = 0;
@@ -179,6 +205,18 @@ private:
     bool              _new_keys;
   };
 
+  /** Check if class T reimplements the @ref UserData::meta_try_index function */
+  template <class T>
+  struct TryIndexOverride
+  {
+    typedef bool (UserData::*ud_try_index_t)(State *ls, const Value &key, Value &value);
+    static char test(ud_try_index_t);
+    template <class X>
+    static long test(bool (X::*)(State *ls, const Value &key, Value &value));
+
+    enum { value = sizeof(test(&T::meta_try_index)) != sizeof(char) };
+  };
+
   template <class T>
   struct Target : public TargetBase
   {
@@ -191,6 +229,8 @@ private:
     /** @override */
     bool _meta_contains(State *ls, const Value &key) const;
     /** @override */
+    bool _meta_try_index(State *ls, const Value &key, Value &value) const;
+    /** @override */
     void _meta_newindex(State *ls, const Value &key, const Value &value) const;
     /** @override */
     Value::List _meta_call(State *ls, const Value::List &args) const;
@@ -212,6 +252,7 @@ private:
     Value get_key() const;
     Value get_value() const;
     ValueRef get_value_ref();
+    int push_next(lua_State *st);
 
     QPointer<State> _state;
     const DispatchProxy &_dp;
@@ -222,6 +263,8 @@ private:
   friend class ProxyIterator;
 
   QList<TargetBase*> _targets;
+  QHash<String, int> _route_cache;
+  bool _route_cache_enabled;
 
 };
 
@@ -30,6 +30,7 @@ namespace QtLua {
   unsigned int DispatchProxy::add_target(T *t, Value::Operations mask, bool new_keys)
   {
     _targets.push_back(new Target<T>(t, mask, new_keys)); 
+    _route_cache.clear();
     return _targets.size() - 1;
   }
 
@@ -38,6 +39,7 @@ namespace QtLua {
 					    Value::Operations mask, bool new_keys)
   {
     _targets.insert(pos, new Target<T>(t, mask, new_keys)); 
+    _route_cache.clear();
     return pos;
   }
 
@@ -48,10 +50,25 @@ namespace QtLua {
       {
 	TargetBase *b = _targets[i];
 	if (b->_ud == t && dynamic_cast<Target<T>*>(b))
-	  _targets.removeAt(i);
+	  {
+	    _targets.removeAt(i);
+	    delete b;
+	  }
 	else
 	  i++;
       }
+
+    _route_cache.clear();
+  }
+
+  bool DispatchProxy::is_route_cache_enabled() const
+  {
+    return _route_cache_enabled;
+  }
+
+  void DispatchProxy::invalidate_route_cache()
+  {
+    _route_cache.clear();
   }
 
   DispatchProxy::TargetBase::TargetBase(UserData *ud, Value::Operations ops, bool new_keys)
@@ -89,6 +106,22 @@ namespace QtLua {
     return static_cast<T*>(_ud)->T::meta_contains(ls, key);
   }
 
+  template <class T>
+  bool DispatchProxy::Target<T>::_meta_try_index(State *ls, const Value &key, Value &value) const
+  {
+    T *t = static_cast<T*>(_ud);
+
+    if (TryIndexOverride<T>::value)
+      return t->T::meta_try_index(ls, key, value);
+
+    // the default implementation would dispatch to virtual functions
+    if (!t->T::meta_contains(ls, key))
+      return false;
+
+    value = t->T::meta_index(ls, key);
+    return true;
+  }
+
   template <class T>
   void DispatchProxy::Target<T>::_meta_newindex(State *ls, const Value &key, const Value &value) const
   {
@@ -77,6 +77,43 @@ public:
   virtual Value get_value() const = 0;
   /** @return reference to current entry value */
   virtual ValueRef get_value_ref() = 0;
+
+  /**
+   * Push current entry key and value on the lua stack and jump to
+   * next entry. This function is used when iterating from lua
+   * code. The default implementation relies on the @ref get_key,
+   * @ref get_value and @ref next functions. It may be reimplemented
+   * to push entries without creating temporary @ref Value objects.
+   *
+   * @return number of values pushed on the stack or 0 if no more
+   * entries are available.
+   */
+  virtual int push_next(lua_State *st);
+
+  /**
+   * @multiple
+   * This function may be used by @ref push_next implementations and
+   * by container proxies to push a C++ value on the lua stack. Common
+   * types are pushed directly, other types are converted using a
+   * temporary @ref Value object.
+   */
+  static void push(lua_State *st, const State *ls, int n);
+  static void push(lua_State *st, const State *ls, unsigned int n);
+  static void push(lua_State *st, const State *ls, long long n);
+  static void push(lua_State *st, const State *ls, float n);
+  static void push(lua_State *st, const State *ls, double n);
+  static void push(lua_State *st, const State *ls, const char *str);
+  static void push(lua_State *st, const State *ls, const String &str);
+  static void push(lua_State *st, const State *ls, const QString &str);
+  static void push(lua_State *st, const State *ls, const Value &v);
+  template <typename X>
+  static inline void push(lua_State *st, const State *ls, const Ref<X> &ud);
+  template <typename X>
+  static inline void push(lua_State *st, const State *ls, const X &x);
+
+private:
+  /** Push an @ref UserData reference or @tt nil if @tt NULL */
+  static void push_userdata(lua_State *st, UserData *ud);
 };
 
 }
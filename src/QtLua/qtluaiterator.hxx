@@ -27,6 +27,18 @@
 
 namespace QtLua {
 
+  template <typename X>
+  void Iterator::push(lua_State *st, const State *ls, const Ref<X> &ud)
+  {
+    push_userdata(st, ud.ptr());
+  }
+
+  template <typename X>
+  void Iterator::push(lua_State *st, const State *ls, const X &x)
+  {
+    Value(ls, x).push_value(st);
+  }
+
 }
 
 #endif
@@ -0,0 +1,149 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008-2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#ifndef QTLUAMAPPEDARRAYPROXY_HH_
+#define QTLUAMAPPEDARRAYPROXY_HH_
+
+#include <QFile>
+#include <QPointer>
+
+#include "qtluauserdata.hh"
+#include "qtluaiterator.hh"
+#include "qtluarangemethod.hh"
+
+namespace QtLua {
+
+  /**
+   * @short Memory mapped file access wrapper for lua script
+   * @header QtLua/MappedArrayProxy
+   * @module {Container proxies}
+   *
+   * This template class may be used to expose the content of a binary
+   * file as an array of @tt T values to lua script. The file is
+   * mapped in memory using the @ref QFile::map function so that data
+   * are loaded by the operating system when accessed. This allows
+   * random access to files much larger than the available memory.
+   *
+   * Records are located at @tt offset in the file and are separated
+   * by @tt stride bytes. The @tt T value is read at the beginning of
+   * each record. Values are copied so that no alignment constraint
+   * applies to @tt offset and @tt stride.
+   *
+   * First entry has index 1. Lua @tt nil value is returned if index
+   * is above array size. Write access is only allowed when the file
+   * has been opened in read/write mode.
+   *
+   * Lua operator @tt # returns the number of records. The @tt get, @tt
+   * set and @tt slice methods are available to access ranges of
+   * records in a single call, as described for the @ref ArrayProxy
+   * class.
+   */
+
+template <class T>
+class MappedArrayProxy : public UserData
+{
+public:
+  QTLUA_REFTYPE(MappedArrayProxy);
+
+  /**
+   * Open and map a file. An exception is thrown if the file can not
+   * be mapped.
+   *
+   * @param filename Path of the file to map.
+   * @param writable Open the file in read/write mode.
+   * @param offset Offset of the first record in the file.
+   * @param stride Distance between records in bytes, defaults to
+   *   @tt{sizeof(T)} when 0.
+   * @param count Number of records, as many records as the file can
+   *   hold when negative.
+   */
+  MappedArrayProxy(const QString &filename, bool writable = false,
+		   qint64 offset = 0, int stride = 0, qint64 count = -1);
+
+  ~MappedArrayProxy();
+
+  /** @This returns the number of records */
+  inline qint64 size() const;
+
+  /** @This returns true if records can be written */
+  inline bool is_writable() const;
+
+  /** @This reads the value of a record */
+  inline T at(qint64 index) const;
+
+  /** @This writes the value of a record, the file must be writable */
+  inline void set(qint64 index, const T &value);
+
+  Value meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b);
+  Value meta_index(State *ls, const Value &key);
+  void meta_newindex(State *ls, const Value &key, const Value &value);
+  bool meta_contains(State *ls, const Value &key);
+  bool meta_try_index(State *ls, const Value &key, Value &value);
+  Ref<Iterator> new_iterator(State *ls);
+  bool support(Value::Operation c) const;
+
+private:
+  void completion_patch(String &path, String &entry, int &offset);
+  String get_type_name() const;
+
+  /** Get record index from lua key, -1 if out of bounds */
+  qint64 get_index(const Value &key) const;
+
+  friend class RangeMethod<MappedArrayProxy>;
+  int range_size() const;
+  int range_max_size() const;
+  void range_get(State *ls, Value::List &list, int offset, int count) const;
+  void range_push(lua_State *st, State *ls, int offset, int count) const;
+  Value range_table(State *ls, int offset, int count) const;
+
+  /**
+   * @short MappedArrayProxy iterator class
+   * @internal
+   */
+  class ProxyIterator : public Iterator
+  {
+  public:
+    QTLUA_REFTYPE(ProxyIterator);
+    ProxyIterator(State *ls, const Ref<MappedArrayProxy> &proxy);
+
+  private:
+    bool more() const;
+    void next();
+    Value get_key() const;
+    Value get_value() const;
+    ValueRef get_value_ref();
+    int push_next(lua_State *st);
+
+    QPointer<State> _ls;
+    Ref<MappedArrayProxy> _proxy;
+    qint64 _it;
+  };
+
+  QFile _file;
+  uchar *_map;
+  qint64 _size;
+  int _stride;
+  bool _writable;
+};
+
+}
+
+#endif
+
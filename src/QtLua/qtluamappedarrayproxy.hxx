@@ -0,0 +1,311 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008-2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#ifndef QTLUAMAPPEDARRAYPROXY_HXX_
+#define QTLUAMAPPEDARRAYPROXY_HXX_
+
+#include <climits>
+#include <cstring>
+#include <QVector>
+
+#include "qtluauserdata.hxx"
+#include "qtluaiterator.hxx"
+#include "qtluarangemethod.hxx"
+
+namespace QtLua {
+
+  template <class T>
+  MappedArrayProxy<T>::MappedArrayProxy(const QString &filename, bool writable,
+					qint64 offset, int stride, qint64 count)
+    : _file(filename),
+      _map(0),
+      _size(0),
+      _stride(stride ? stride : (int)sizeof(T)),
+      _writable(writable)
+  {
+    if (_stride < (int)sizeof(T) || offset < 0)
+      QTLUA_THROW(QtLua::MappedArrayProxy, "Bad record layout for the `%' file.", .arg(filename));
+
+    if (!_file.open(writable ? QIODevice::ReadWrite : QIODevice::ReadOnly))
+      QTLUA_THROW(QtLua::MappedArrayProxy, "Unable to open the `%' file: %.",
+		  .arg(filename).arg(_file.errorString()));
+
+    qint64 avail = _file.size() - offset;
+    qint64 max = avail >= (qint64)sizeof(T) ? (avail - (qint64)sizeof(T)) / _stride + 1 : 0;
+
+    if (count < 0)
+      count = max;
+    else if (count > max)
+      QTLUA_THROW(QtLua::MappedArrayProxy, "The `%' file is too small to hold % records.",
+		  .arg(filename).arg(count));
+
+    if (count)
+      {
+	_map = _file.map(offset, (count - 1) * _stride + sizeof(T));
+
+	if (!_map)
+	  QTLUA_THROW(QtLua::MappedArrayProxy, "Unable to map the `%' file: %.",
+		      .arg(filename).arg(_file.errorString()));
+      }
+
+    _size = count;
+  }
+
+  template <class T>
+  MappedArrayProxy<T>::~MappedArrayProxy()
+  {
+    if (_map)
+      _file.unmap(_map);
+  }
+
+  template <class T>
+  qint64 MappedArrayProxy<T>::size() const
+  {
+    return _size;
+  }
+
+  template <class T>
+  bool MappedArrayProxy<T>::is_writable() const
+  {
+    return _writable;
+  }
+
+  template <class T>
+  T MappedArrayProxy<T>::at(qint64 index) const
+  {
+    T value;
+    std::memcpy(&value, _map + index * _stride, sizeof(T));
+    return value;
+  }
+
+  template <class T>
+  void MappedArrayProxy<T>::set(qint64 index, const T &value)
+  {
+    std::memcpy(_map + index * _stride, &value, sizeof(T));
+  }
+
+  template <class T>
+  qint64 MappedArrayProxy<T>::get_index(const Value &key) const
+  {
+    qint64 index = key.to_longlong() - 1;
+
+    return index >= 0 && index < _size ? index : -1;
+  }
+
+  template <class T>
+  Value MappedArrayProxy<T>::meta_index(State *ls, const Value &key)
+  { 
+    if (RangeMethod<MappedArrayProxy> *m = RangeMethod<MappedArrayProxy>::get(key))
+      return Value(ls, m);
+
+    qint64 index = get_index(key);
+
+    if (index >= 0)
+      return Value(ls, at(index));
+    else
+      return Value(ls);
+  }
+
+  template <class T>
+  bool MappedArrayProxy<T>::meta_contains(State *ls, const Value &key)
+  {
+    try {
+      return get_index(key) >= 0;
+    } catch (String &e) {
+      return false;
+    }
+  }
+
+  template <class T>
+  bool MappedArrayProxy<T>::meta_try_index(State *ls, const Value &key, Value &value)
+  {
+    qint64 index;
+
+    try {
+      index = get_index(key);
+    } catch (String &e) {
+      return false;
+    }
+
+    if (index < 0)
+      return false;
+
+    value = Value(ls, at(index));
+    return true;
+  }
+
+  template <class T>
+  void MappedArrayProxy<T>::meta_newindex(State *ls, const Value &key, const Value &value)
+  {
+    if (!_writable)
+      QTLUA_THROW(QtLua::MappedArrayProxy, "Can not write to the read only `%' file.",
+		  .arg(_file.fileName()));
+
+    qint64 index = get_index(key);
+
+    if (index < 0)
+      QTLUA_THROW(QtLua::MappedArrayProxy, "Array index `%' is out of bounds.",
+		  .arg(key.to_string_p()));
+
+    T x = value;
+    set(index, x);
+  }
+
+  template <class T>
+  Value MappedArrayProxy<T>::meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b)
+  {
+    switch (op)
+      {
+      case Value::OpLen:
+	return Value(ls, (long long)_size);
+      case Value::OpUnm:
+	return range_table(ls, 0, range_size());
+      default:
+	return UserData::meta_operation(ls, op, a, b);
+      }
+  }
+
+  template <class T>
+  bool MappedArrayProxy<T>::support(Value::Operation c) const
+  {
+    switch (c)
+      {
+      case Value::OpNewindex:
+	return _writable;
+      case Value::OpIndex:
+      case Value::OpIterate:
+      case Value::OpLen:
+      case Value::OpUnm:
+	return true;
+      default:
+	return false;
+      }
+  }
+
+  template <class T>
+  String MappedArrayProxy<T>::get_type_name() const
+  {
+    return type_name<T>() + "[" + String::number(_size) + "]";
+  }
+
+  template <class T>
+  Ref<Iterator> MappedArrayProxy<T>::new_iterator(State *ls)
+  {
+    return QTLUA_REFNEW(ProxyIterator, ls, *this);
+  }
+
+  template <class T>
+  MappedArrayProxy<T>::ProxyIterator::ProxyIterator(State *ls, const Ref<MappedArrayProxy> &proxy)
+    : _ls(ls),
+      _proxy(proxy),
+      _it(0)
+  {
+  }
+
+  template <class T>
+  bool MappedArrayProxy<T>::ProxyIterator::more() const
+  {
+    return _it < _proxy->_size;
+  }
+
+  template <class T>
+  void MappedArrayProxy<T>::ProxyIterator::next()
+  {
+    _it++;
+  }
+
+  template <class T>
+  Value MappedArrayProxy<T>::ProxyIterator::get_key() const
+  {
+    return Value(_ls, (long long)_it + 1);
+  }
+
+  template <class T>
+  Value MappedArrayProxy<T>::ProxyIterator::get_value() const
+  {
+    return Value(_ls, _proxy->at(_it));
+  }
+
+  template <class T>
+  ValueRef MappedArrayProxy<T>::ProxyIterator::get_value_ref()
+  {
+    return ValueRef(Value(_ls, _proxy), Value(_ls, (long long)_it + 1));
+  }
+
+  template <class T>
+  int MappedArrayProxy<T>::ProxyIterator::push_next(lua_State *st)
+  {
+    if (!more())
+      return 0;
+
+    push(st, _ls, (long long)_it + 1);
+    push(st, _ls, _proxy->at(_it));
+    _it++;
+    return 2;
+  }
+
+  template <class T>
+  int MappedArrayProxy<T>::range_size() const
+  {
+    return _size > INT_MAX ? INT_MAX : (int)_size;
+  }
+
+  template <class T>
+  int MappedArrayProxy<T>::range_max_size() const
+  {
+    return range_size();
+  }
+
+  template <class T>
+  void MappedArrayProxy<T>::range_get(State *ls, Value::List &list, int offset, int count) const
+  {
+    for (int i = 0; i < count; i++)
+      list.append(Value(ls, at(offset + i)));
+  }
+
+  template <class T>
+  void MappedArrayProxy<T>::range_push(lua_State *st, State *ls, int offset, int count) const
+  {
+    for (int i = 0; i < count; i++)
+      Iterator::push(st, ls, at(offset + i));
+  }
+
+  template <class T>
+  Value MappedArrayProxy<T>::range_table(State *ls, int offset, int count) const
+  {
+    QVector<T> v(count);
+
+    for (int i = 0; i < count; i++)
+      v[i] = at(offset + i);
+
+    return Value(ls, (unsigned int)count, v.constData());
+  }
+
+  template <class T>
+  void MappedArrayProxy<T>::completion_patch(String &path, String &entry, int &offset)
+  {
+    entry += "[]";
+    offset--;
+  }
+
+}
+
+#endif
+
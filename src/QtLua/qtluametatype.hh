@@ -38,10 +38,11 @@ namespace QtLua {
 
   /** @internal */
   typedef MetaType<void> metatype_void_t;
+  /** @internal Attach conversion handler to a Qt meta type, throw if
+      a handler is already registered for this type. */
+  void metatype_register(int type, metatype_void_t *mt);
   /** @internal */
-  typedef QMap<int, metatype_void_t* > metatype_map_t;
-  /** @internal */
-  extern metatype_map_t types_map;
+  void metatype_unregister(int type);
 
   /**
    * @short Register Lua to Qt meta types conversion functions
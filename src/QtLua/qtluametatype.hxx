@@ -28,17 +28,10 @@ namespace QtLua {
   template <typename X>
   MetaType<X>::MetaType(const char *name)
     {
-      if ((_type = QMetaType::type(name)))
-	{
-	  if (types_map.contains(_type))
-	    QTLUA_THROW(QtLua::MetaType, "A lua conversion handler is already registered for the `%' type.", .arg(_type));
-	}
-      else
-	{
-	  _type = qRegisterMetaType<X>(name);
-	}
-
-      types_map.insert(_type, reinterpret_cast<metatype_void_t*>(this));
+      if (!(_type = QMetaType::type(name)))
+	_type = qRegisterMetaType<X>(name);
+
+      metatype_register(_type, reinterpret_cast<metatype_void_t*>(this));
     }
 
   template <typename X>
@@ -46,16 +39,13 @@ namespace QtLua {
     {
       _type = type;
 
-      if (types_map.contains(type))
-	QTLUA_THROW(QtLua::MetaType, "A lua conversion handler is already registered for type handle `%'.", .arg(_type));
-
-      types_map.insert(type, reinterpret_cast<metatype_void_t*>(this));
+      metatype_register(type, reinterpret_cast<metatype_void_t*>(this));
     }
 
   template <typename X>
   MetaType<X>::~MetaType()
     {
-      types_map.remove(_type);
+      metatype_unregister(_type);
     }
 
   template <typename X>
@@ -0,0 +1,183 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008-2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#ifndef QTLUANUMARRAY_HH_
+#define QTLUANUMARRAY_HH_
+
+#include <QVector>
+
+#include "qtluauserdata.hh"
+#include "qtluavalue.hh"
+
+namespace QtLua {
+
+  /** @internal Element type properties of numeric arrays */
+  template <typename T>
+  struct numarray_traits;
+
+#define QTLUA_NUMARRAY_TRAITS(T, accum_t, real_t, integral_, name_)	\
+  template <>								\
+  struct numarray_traits<T>						\
+  {									\
+    /* type used for sum and dot product accumulation */		\
+    typedef accum_t accum;						\
+    /* type used for transcendental functions */			\
+    typedef real_t real;						\
+    enum { integral = integral_ };					\
+									\
+    static const char * name()						\
+    {									\
+      return name_;							\
+    }									\
+  };
+
+  QTLUA_NUMARRAY_TRAITS(float, double, float, 0, "float")
+  QTLUA_NUMARRAY_TRAITS(double, double, double, 0, "double")
+  QTLUA_NUMARRAY_TRAITS(qint32, qint64, double, 1, "int32")
+  QTLUA_NUMARRAY_TRAITS(qint64, qint64, double, 1, "int64")
+
+#undef QTLUA_NUMARRAY_TRAITS
+
+  /**
+   * @short Typed numeric array userdata
+   * @header QtLua/NumArray
+   * @module {Base}
+   *
+   * This class exposes a contiguous array of numbers to lua. Unlike
+   * @ref QVectorProxy objects, it provides bulk operations which
+   * process the whole array in a single native loop, avoiding the
+   * cost of one metamethod call per element in lua code.
+   *
+   * The array storage is a @ref QVector which is implicitly shared
+   * with the @ref QVector passed to the constructor and returned by
+   * the @ref get_vector function, no copy is performed in either
+   * direction until one side is modified.
+   *
+   * This template class is instantiated for the @tt float, @tt double,
+   * @tt qint32 and @tt qint64 element types.
+   *
+   * The following operations are available from lua:
+   * @list
+   *   @item @tt{#array} returns the number of elements,
+   *   @item @tt{array[i]} reads or writes the element at index @tt i starting at 1,
+   *   @item @tt{array:sum()}, @tt{array:min()} and @tt{array:max()}
+   *     return the sum, the smallest and the largest elements,
+   *   @item @tt{array:scale(k)} multiplies all elements by @tt k,
+   *   @item @tt{array:axpy(a, x)} adds @tt a times the elements of
+   *     array @tt x to the elements of @tt array,
+   *   @item @tt{array:dot(x)} returns the dot product with array @tt x,
+   *   @item @tt{array:map(op)} applies a builtin operation to all
+   *     elements. Available operations are @tt abs, @tt neg, @tt square,
+   *     @tt sqrt, @tt exp, @tt log, @tt sin, @tt cos, @tt floor and @tt ceil,
+   *   @item @tt{array:slice(i [, j])} returns a new array with a copy of
+   *     a sub range with the same index conventions as the lua
+   *     @tt{string.sub} function,
+   *   @item @tt{array:copy_from(x [, i])} copies elements of array
+   *     @tt x starting at index @tt i.
+   * @end list
+   */
+  template <typename T>
+  class NumArray : public UserData
+  {
+  public:
+    QTLUA_REFTYPE(NumArray);
+
+    /** Element wise operations available for the @ref map function */
+    enum MapOp
+      {
+	MapAbs, MapNeg, MapSquare, MapSqrt, MapExp,
+	MapLog, MapSin, MapCos, MapFloor, MapCeil
+      };
+
+    /** Create a zero filled array */
+    NumArray(int size = 0);
+
+    /** Create an array sharing storage of the given vector */
+    NumArray(const QVector<T> &vector);
+
+    /** Create a zero filled array from a size or an array filled
+	with the elements of a lua table. Throws if the size is
+	negative. */
+    static ptr from_value(const Value &init);
+
+    /** Type used to accumulate elements, wider than @tt T for
+	integral types so that sums do not overflow. */
+    typedef typename numarray_traits<T>::accum accum_type;
+
+    /** @This returns a vector sharing storage with the array */
+    inline const QVector<T> & get_vector() const;
+
+    /** @This returns the number of elements */
+    inline int size() const;
+
+    /** @This returns a pointer to the first element */
+    inline const T * data() const;
+
+    /** @This returns a pointer to the first element, storage is
+	detached if shared. */
+    inline T * data();
+
+    /** @This returns the sum of all elements */
+    accum_type sum() const;
+
+    /** @This returns the smallest element, throws if the array is empty */
+    T min() const;
+
+    /** @This returns the largest element, throws if the array is empty */
+    T max() const;
+
+    /** @This multiplies all elements by @tt k */
+    void scale(T k);
+
+    /** @This adds @tt a times the elements of @tt x to the array
+	elements. Both arrays must have the same size. */
+    void axpy(T a, const NumArray &x);
+
+    /** @This returns the dot product of both arrays. Both arrays
+	must have the same size. */
+    accum_type dot(const NumArray &x) const;
+
+    /** @This applies a builtin operation to all elements */
+    void map(MapOp op);
+
+    /** @This returns a new array with a copy of @tt size elements
+	starting at @tt offset. */
+    ptr slice(int offset, int size) const;
+
+    /** @This copies all elements of @tt src in the array starting
+	at @tt offset. */
+    void copy_from(const NumArray &src, int offset = 0);
+
+  private:
+    Value meta_index(State *ls, const Value &key);
+    void meta_newindex(State *ls, const Value &key, const Value &value);
+    Value meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b);
+    bool support(Value::Operation c) const;
+    String get_value_str() const;
+
+    class Method;
+
+    QVector<T> _data;
+  };
+
+}
+
+#endif
+
@@ -33,6 +33,8 @@ namespace QtLua {
   struct QHashProxyKeytype
   {
     static inline void completion_patch(String &path, String &entry, int &offset);
+    /** Get a key suitable for container lookup */
+    static inline T lookup_key(const Value &key);
   };
 
   /** @module {Container proxies} @internal */
@@ -40,6 +42,9 @@ namespace QtLua {
   struct QHashProxyKeytype<String>
   {
     static inline void completion_patch(String &path, String &entry, int &offset);
+    /** Get a key sharing the lua string buffer, the key must not be
+	stored in the container. */
+    static inline String lookup_key(const Value &key);
   };
 
   /**
@@ -70,6 +75,7 @@ public:
 
   Value meta_index(State *ls, const Value &key);
   bool meta_contains(State *ls, const Value &key);
+  bool meta_try_index(State *ls, const Value &key, Value &value);
   Ref<Iterator> new_iterator(State *ls);
   Value meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b);
   bool support(Value::Operation c) const;
@@ -94,6 +100,7 @@ private:
     Value get_key() const;
     Value get_value() const;
     ValueRef get_value_ref();
+    int push_next(lua_State *st);
 
     QPointer<State> _ls;
     Ref<QHashProxyRo> _proxy;
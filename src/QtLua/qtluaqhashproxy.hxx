@@ -62,7 +62,8 @@ namespace QtLua {
     if (!_hash)
       return Value(ls);
 
-    typename Container::iterator i = _hash->find(key);
+    typename Container::iterator i = _hash->find(
+      QHashProxyKeytype<typename Container::key_type>::lookup_key(key));
 
     if (i == _hash->end())
       return Value(ls);
@@ -73,7 +74,24 @@ namespace QtLua {
   template <class Container>
   bool QHashProxyRo<Container>::meta_contains(State *ls, const Value &key)
   {
-    return _hash->contains(key);
+    return _hash && _hash->contains(
+      QHashProxyKeytype<typename Container::key_type>::lookup_key(key));
+  }
+
+  template <class Container>
+  bool QHashProxyRo<Container>::meta_try_index(State *ls, const Value &key, Value &value)
+  {
+    if (!_hash)
+      return false;
+
+    typename Container::const_iterator i = _hash->constFind(
+      QHashProxyKeytype<typename Container::key_type>::lookup_key(key));
+
+    if (i == _hash->constEnd())
+      return false;
+
+    value = Value(ls, i.value());
+    return true;
   }
 
   template <class Container>
@@ -128,7 +146,7 @@ namespace QtLua {
       QTLUA_THROW(QtLua::QHashProxy, "Can not index a null container.");
 
     else if (value.type() == Value::TNil)
-      _hash->remove(key);
+      _hash->remove(QHashProxyKeytype<typename Container::key_type>::lookup_key(key));
     else
       _hash->insert(key, value);
   }
@@ -180,6 +198,18 @@ namespace QtLua {
     return ValueRef(Value(_ls, _proxy), Value(_ls, _it.key()));
   }
 
+  template <class Container>
+  int QHashProxyRo<Container>::ProxyIterator::push_next(lua_State *st)
+  {
+    if (!more())
+      return 0;
+
+    push(st, _ls, _it.key());
+    push(st, _ls, _it.value());
+    _it++;
+    return 2;
+  }
+
   template <typename T>
   void QHashProxyKeytype<T>::completion_patch(String &path, String &entry, int &offset)
   {
@@ -192,6 +222,17 @@ namespace QtLua {
     entry += ".";
   }
 
+  template <typename T>
+  T QHashProxyKeytype<T>::lookup_key(const Value &key)
+  {
+    return key;
+  }
+
+  String QHashProxyKeytype<String>::lookup_key(const Value &key)
+  {
+    return key.to_string_ref();
+  }
+
   template <class Container>
   void QHashProxyRo<Container>::completion_patch(String &path, String &entry, int &offset)
   {
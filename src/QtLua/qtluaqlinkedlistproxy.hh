@@ -79,6 +79,7 @@ private:
     Value get_key() const;
     Value get_value() const;
     ValueRef get_value_ref();
+    int push_next(lua_State *st);
 
     QPointer<State> _ls;
     Ref<QLinkedListProxy> _proxy;
@@ -108,7 +108,20 @@ namespace QtLua {
   template <class Container>
   ValueRef QLinkedListProxy<Container>::ProxyIterator::get_value_ref()
   {
-    return ValueRef(Value(_ls, _proxy), Value(_ls, (double)_i));
+    return ValueRef(Value(_ls, _proxy), Value(_ls, (int)_i));
+  }
+
+  template <class Container>
+  int QLinkedListProxy<Container>::ProxyIterator::push_next(lua_State *st)
+  {
+    if (!more())
+      return 0;
+
+    push(st, _ls, (int)_i);
+    push(st, _ls, *_it);
+    _it++;
+    _i++;
+    return 2;
   }
 
 }
@@ -25,6 +25,7 @@
 
 #include "qtluauserdata.hh"
 #include "qtluaiterator.hh"
+#include "qtluarangemethod.hh"
 
 namespace QtLua {
 
@@ -54,8 +55,13 @@ public:
   /** Attach or detach container. argument may be NULL */
   void set_container(Container *list);
 
+  /** Make iterators work on an implicitly shared copy of the
+      container taken when the iteration starts. Disabled by default. */
+  void set_snapshot(bool snapshot);
+
   Value meta_index(State *ls, const Value &key);
   bool meta_contains(State *ls, const Value &key);
+  bool meta_try_index(State *ls, const Value &key, Value &value);
   Ref<Iterator> new_iterator(State *ls);
   Value meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b);
   bool support(Value::Operation c) const;
@@ -64,6 +70,13 @@ private:
   void completion_patch(String &path, String &entry, int &offset);
   String get_type_name() const;
 
+  friend class RangeMethod<QListProxyRo>;
+  int range_size() const;
+  int range_max_size() const;
+  void range_get(State *ls, Value::List &list, int offset, int count) const;
+  void range_push(lua_State *st, State *ls, int offset, int count) const;
+  Value range_table(State *ls, int offset, int count) const;
+
   /**
    * @short QListProxyRo iterator class
    * @internal
@@ -80,15 +93,33 @@ private:
     Value get_key() const;
     Value get_value() const;
     ValueRef get_value_ref();
+    int push_next(lua_State *st);
 
     QPointer<State> _ls;
     Ref<QListProxyRo> _proxy;
-    typename Container::const_iterator _it;
     unsigned int _i;
   };
 
+  class SnapshotProxy;
+
 protected:
   Container *_list;
+  bool _snapshot;
+};
+
+  /**
+   * @short Read only proxy to a copy of the container used by snapshot iterators
+   * @internal
+   */
+template <class Container>
+class QListProxyRo<Container>::SnapshotProxy : public QListProxyRo<Container>
+{
+public:
+  QTLUA_REFTYPE(SnapshotProxy);
+  SnapshotProxy(const Container &list);
+
+private:
+  Container _copy;
 };
 
   /**
@@ -113,6 +144,22 @@ protected:
    * Lua operator @tt # returns the container entry count. Lua
    * operator @tt - returns a lua table copy of the container.
    *
+   * Iterators access the attached container directly. When enabled
+   * with @ref QListProxyRo::set_snapshot, iterators work on an
+   * implicitly shared copy of the container taken when the iteration
+   * starts instead. This copy is cheap and lua reads a consistent view
+   * even if the container is modified from C++ during iteration. Data
+   * are only duplicated if the container is modified before the
+   * iteration ends. Values references obtained from such iterators
+   * read the copy and can not be assigned.
+   *
+   * Ranges of elements can be accessed in a single call: @tt{p:get(i
+   * [, n])} returns up to @tt n elements starting at index @tt i as
+   * multiple values, @tt{p:set(i, table)} writes table elements
+   * starting at index @tt i and @tt{p:slice(i [, j])} returns a lua
+   * table copy of a sub range with the same index conventions as the
+   * lua @tt{string.sub} function.
+   *
    * The following example show how a @ref QList object can be
    * accessed from both C++ and lua script directly:
    *
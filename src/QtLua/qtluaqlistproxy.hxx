@@ -21,23 +21,35 @@
 #ifndef QTLUAQLISTPROXY_HXX_
 #define QTLUAQLISTPROXY_HXX_
 
+#include <climits>
+
 #include "qtluauserdata.hxx"
 #include "qtluaiterator.hxx"
+#include "qtluarangemethod.hxx"
 
 namespace QtLua {
 
   template <class Container>
   QListProxyRo<Container>::QListProxyRo()
-    : _list(0)
+    : _list(0),
+      _snapshot(false)
   {
   }
 
   template <class Container>
   QListProxyRo<Container>::QListProxyRo(Container &list)
-    : _list(&list)
+    : _list(&list),
+      _snapshot(false)
   {
   }
 
+  template <class Container>
+  QListProxyRo<Container>::SnapshotProxy::SnapshotProxy(const Container &list)
+    : _copy(list)
+  {
+    this->_list = &_copy;
+  }
+
   template <class Container>
   QListProxy<Container>::QListProxy()
     : QListProxyRo<Container>()
@@ -56,13 +68,22 @@ namespace QtLua {
     _list = list;
   }
 
+  template <class Container>
+  void QListProxyRo<Container>::set_snapshot(bool snapshot)
+  {
+    _snapshot = snapshot;
+  }
+
   template <class Container>
   Value QListProxyRo<Container>::meta_index(State *ls, const Value &key)
   {
+    if (RangeMethod<QListProxyRo> *m = RangeMethod<QListProxyRo>::get(key))
+      return Value(ls, m);
+
     if (!_list)
       return Value(ls);
 
-    int index = (unsigned int)key.to_number() - 1;
+    int index = (unsigned int)key.to_integer() - 1;
 
     if (index >= 0 && index < _list->size())
       return Value(ls, _list->at(index));
@@ -74,7 +95,7 @@ namespace QtLua {
   bool QListProxyRo<Container>::meta_contains(State *ls, const Value &key)
   {
     try {
-      int index = (unsigned int)key.to_number() - 1;
+      int index = (unsigned int)key.to_integer() - 1;
 
       return index >= 0 && index < _list->size();
     } catch (String &e) {
@@ -82,6 +103,27 @@ namespace QtLua {
     }
   }
 
+  template <class Container>
+  bool QListProxyRo<Container>::meta_try_index(State *ls, const Value &key, Value &value)
+  {
+    if (!_list)
+      return false;
+
+    int index;
+
+    try {
+      index = (unsigned int)key.to_integer() - 1;
+    } catch (String &e) {
+      return false;
+    }
+
+    if (index < 0 || index >= _list->size())
+      return false;
+
+    value = Value(ls, _list->at(index));
+    return true;
+  }
+
   template <class Container>
   Value QListProxyRo<Container>::meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b)
   {
@@ -133,6 +175,40 @@ namespace QtLua {
     return type_name<Container>();
   }
 
+  template <class Container>
+  int QListProxyRo<Container>::range_size() const
+  {
+    return _list ? _list->size() : 0;
+  }
+
+  template <class Container>
+  int QListProxyRo<Container>::range_max_size() const
+  {
+    // lists grow by appending, a gap is reported by meta_newindex
+    // before anything is written
+    return _list ? INT_MAX : 0;
+  }
+
+  template <class Container>
+  void QListProxyRo<Container>::range_get(State *ls, Value::List &list, int offset, int count) const
+  {
+    for (int i = 0; i < count; i++)
+      list.append(Value(ls, _list->at(offset + i)));
+  }
+
+  template <class Container>
+  void QListProxyRo<Container>::range_push(lua_State *st, State *ls, int offset, int count) const
+  {
+    for (int i = 0; i < count; i++)
+      Iterator::push(st, ls, _list->at(offset + i));
+  }
+
+  template <class Container>
+  Value QListProxyRo<Container>::range_table(State *ls, int offset, int count) const
+  {
+    return Value(ls, _list->mid(offset, count));
+  }
+
   template <class Container>
   void QListProxyRo<Container>::completion_patch(String &path, String &entry, int &offset)
   {
@@ -146,7 +222,7 @@ namespace QtLua {
     if (!_list)
       QTLUA_THROW(QtLua::QListProxy, "Can not index a null container.");
 
-    unsigned int index = (unsigned int)key.to_number() - 1;
+    unsigned int index = (unsigned int)key.to_integer() - 1;
 
     if (index > (unsigned int)_list->size())
       QTLUA_THROW(QtLua::QListProxy, "Index % is out of bounds.", .arg(index));
@@ -171,6 +247,10 @@ namespace QtLua {
     if (!_list)
       QTLUA_THROW(QtLua::QListProxyRo, "Can not iterate on a null container.");
 
+    // iterate on a read only proxy to an implicitly shared copy
+    if (_snapshot)
+      return QTLUA_REFNEW(ProxyIterator, ls, QTLUA_REFNEW(SnapshotProxy, *_list));
+
     return QTLUA_REFNEW(ProxyIterator, ls, *this);
   }
 
@@ -178,7 +258,6 @@ namespace QtLua {
   QListProxyRo<Container>::ProxyIterator::ProxyIterator(State *ls, const Ref<QListProxyRo> &proxy)
     : _ls(ls),
       _proxy(proxy),
-      _it(_proxy->_list->begin()),
       _i(1)
   {
   }
@@ -186,13 +265,12 @@ namespace QtLua {
   template <class Container>
   bool QListProxyRo<Container>::ProxyIterator::more() const
   {
-    return _proxy->_list && _it != _proxy->_list->end();
+    return _proxy->_list && _i <= (unsigned int)_proxy->_list->size();
   }
 
   template <class Container>
   void QListProxyRo<Container>::ProxyIterator::next()
   {
-    _it++;
     _i++;
   }
 
@@ -205,13 +283,25 @@ namespace QtLua {
   template <class Container>
   Value QListProxyRo<Container>::ProxyIterator::get_value() const
   {
-    return Value(_ls, *_it);
+    return Value(_ls, _proxy->_list->at(_i - 1));
   }
 
   template <class Container>
   ValueRef QListProxyRo<Container>::ProxyIterator::get_value_ref()
   {
-    return ValueRef(Value(_ls, _proxy), Value(_ls, (double)_i));
+    return ValueRef(Value(_ls, _proxy), Value(_ls, (int)_i));
+  }
+
+  template <class Container>
+  int QListProxyRo<Container>::ProxyIterator::push_next(lua_State *st)
+  {
+    if (!more())
+      return 0;
+
+    push(st, _ls, (int)_i);
+    push(st, _ls, _proxy->_list->at(_i - 1));
+    _i++;
+    return 2;
   }
 
 }
@@ -25,6 +25,7 @@
 
 #include "qtluauserdata.hh"
 #include "qtluaiterator.hh"
+#include "qtluarangemethod.hh"
 
 namespace QtLua {
 
@@ -59,9 +60,14 @@ public:
   /** Attach or detach container. argument may be NULL */
   void set_container(Container *vector);
 
+  /** Make iterators work on an implicitly shared copy of the
+      container taken when the iteration starts. Disabled by default. */
+  void set_snapshot(bool snapshot);
+
   Value meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b);
   Value meta_index(State *ls, const Value &key);
   bool meta_contains(State *ls, const Value &key);
+  bool meta_try_index(State *ls, const Value &key, Value &value);
   Ref<Iterator> new_iterator(State *ls);
   bool support(Value::Operation c) const;
 
@@ -69,6 +75,13 @@ private:
   void completion_patch(String &path, String &entry, int &offset);
   String get_type_name() const;
 
+  friend class RangeMethod<QVectorProxyRo>;
+  int range_size() const;
+  int range_max_size() const;
+  void range_get(State *ls, Value::List &list, int offset, int count) const;
+  void range_push(lua_State *st, State *ls, int offset, int count) const;
+  Value range_table(State *ls, int offset, int count) const;
+
   /**
    * @short QVectorProxyRo iterator class
    * @internal
@@ -85,14 +98,34 @@ private:
     Value get_key() const;
     Value get_value() const;
     ValueRef get_value_ref();
+    int push_next(lua_State *st);
 
     QPointer<State> _ls;
     Ref<QVectorProxyRo> _proxy;
     unsigned int _it;
   };
 
+  class SnapshotProxy;
+
 protected:
   Container *_vector;
+  bool _snapshot;
+};
+
+  /**
+   * @short Read only proxy to a copy of the container used by snapshot iterators
+   * @internal
+   */
+template <class Container, unsigned int max_resize, unsigned int min_resize>
+class QVectorProxyRo<Container, max_resize, min_resize>::SnapshotProxy
+  : public QVectorProxyRo<Container, max_resize, min_resize>
+{
+public:
+  QTLUA_REFTYPE(SnapshotProxy);
+  SnapshotProxy(const Container &vector);
+
+private:
+  Container _copy;
 };
 
   /**
@@ -119,6 +152,22 @@ protected:
    * Lua operator @tt # returns the container entry count. Lua
    * operator @tt - returns a lua table copy of the container.
    *
+   * Iterators access the attached container directly. When enabled
+   * with @ref QVectorProxyRo::set_snapshot, iterators work on an
+   * implicitly shared copy of the container taken when the iteration
+   * starts instead. This copy is cheap and lua reads a consistent view
+   * even if the container is modified from C++ during iteration. Data
+   * are only duplicated if the container is modified before the
+   * iteration ends. Values references obtained from such iterators
+   * read the copy and can not be assigned.
+   *
+   * Ranges of elements can be accessed in a single call: @tt{p:get(i
+   * [, n])} returns up to @tt n elements starting at index @tt i as
+   * multiple values, @tt{p:set(i, table)} writes table elements
+   * starting at index @tt i and @tt{p:slice(i [, j])} returns a lua
+   * table copy of a sub range with the same index conventions as the
+   * lua @tt{string.sub} function.
+   *
    * The following example show how a @ref QVector object can be
    * accessed from both C++ and lua script directly:
    *
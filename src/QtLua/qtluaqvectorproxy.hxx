@@ -23,21 +23,31 @@
 
 #include "qtluauserdata.hxx"
 #include "qtluaiterator.hxx"
+#include "qtluarangemethod.hxx"
 
 namespace QtLua {
 
   template <class Container, unsigned max_resize, unsigned min_resize>
   QVectorProxyRo<Container, max_resize, min_resize>::QVectorProxyRo()
-    : _vector(0)
+    : _vector(0),
+      _snapshot(false)
   {
   }
 
   template <class Container, unsigned max_resize, unsigned min_resize>
   QVectorProxyRo<Container, max_resize, min_resize>::QVectorProxyRo(Container &vector)
-    : _vector(&vector)
+    : _vector(&vector),
+      _snapshot(false)
   {
   }
 
+  template <class Container, unsigned max_resize, unsigned min_resize>
+  QVectorProxyRo<Container, max_resize, min_resize>::SnapshotProxy::SnapshotProxy(const Container &vector)
+    : _copy(vector)
+  {
+    this->_vector = &_copy;
+  }
+
   template <class Container, unsigned max_resize, unsigned min_resize>
   QVectorProxy<Container, max_resize, min_resize>::QVectorProxy()
     : QVectorProxyRo<Container, max_resize, min_resize>()
@@ -56,13 +66,22 @@ namespace QtLua {
     _vector = vector;
   }
 
+  template <class Container, unsigned max_resize, unsigned min_resize>
+  void QVectorProxyRo<Container, max_resize, min_resize>::set_snapshot(bool snapshot)
+  {
+    _snapshot = snapshot;
+  }
+
   template <class Container, unsigned max_resize, unsigned min_resize>
   Value QVectorProxyRo<Container, max_resize, min_resize>::meta_index(State *ls, const Value &key)
   { 
+    if (RangeMethod<QVectorProxyRo> *m = RangeMethod<QVectorProxyRo>::get(key))
+      return Value(ls, m);
+
     if (!_vector)
       return Value(ls);
 
-    int index = (unsigned int)key.to_number() - 1;
+    int index = (unsigned int)key.to_integer() - 1;
 
     if (index >= 0 && index < _vector->size())
       return Value(ls, _vector->at(index));
@@ -74,7 +93,7 @@ namespace QtLua {
   bool QVectorProxyRo<Container, max_resize, min_resize>::meta_contains(State *ls, const Value &key)
   {
     try {
-      int index = (unsigned int)key.to_number() - 1;
+      int index = (unsigned int)key.to_integer() - 1;
 
       return index >= 0 && index < _vector->size();
     } catch (String &e) {
@@ -82,6 +101,27 @@ namespace QtLua {
     }
   }
 
+  template <class Container, unsigned max_resize, unsigned min_resize>
+  bool QVectorProxyRo<Container, max_resize, min_resize>::meta_try_index(State *ls, const Value &key, Value &value)
+  {
+    if (!_vector)
+      return false;
+
+    int index;
+
+    try {
+      index = (unsigned int)key.to_integer() - 1;
+    } catch (String &e) {
+      return false;
+    }
+
+    if (index < 0 || index >= _vector->size())
+      return false;
+
+    value = Value(ls, _vector->at(index));
+    return true;
+  }
+
   template <class Container, unsigned max_resize, unsigned min_resize>
   Value QVectorProxyRo<Container, max_resize, min_resize>::meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b)
   {
@@ -133,6 +173,41 @@ namespace QtLua {
     return type_name<Container>();
   }
 
+  template <class Container, unsigned max_resize, unsigned min_resize>
+  int QVectorProxyRo<Container, max_resize, min_resize>::range_size() const
+  {
+    return _vector ? _vector->size() : 0;
+  }
+
+  template <class Container, unsigned max_resize, unsigned min_resize>
+  int QVectorProxyRo<Container, max_resize, min_resize>::range_max_size() const
+  {
+    bool has_resize = max_resize > min_resize;
+    int size = range_size();
+
+    return has_resize && (int)max_resize > size ? (int)max_resize : size;
+  }
+
+  template <class Container, unsigned max_resize, unsigned min_resize>
+  void QVectorProxyRo<Container, max_resize, min_resize>::range_get(State *ls, Value::List &list, int offset, int count) const
+  {
+    for (int i = 0; i < count; i++)
+      list.append(Value(ls, _vector->at(offset + i)));
+  }
+
+  template <class Container, unsigned max_resize, unsigned min_resize>
+  void QVectorProxyRo<Container, max_resize, min_resize>::range_push(lua_State *st, State *ls, int offset, int count) const
+  {
+    for (int i = 0; i < count; i++)
+      Iterator::push(st, ls, _vector->at(offset + i));
+  }
+
+  template <class Container, unsigned max_resize, unsigned min_resize>
+  Value QVectorProxyRo<Container, max_resize, min_resize>::range_table(State *ls, int offset, int count) const
+  {
+    return Value(ls, (unsigned int)count, _vector->constData() + offset);
+  }
+
   template <class Container, unsigned max_resize, unsigned min_resize>
   void QVectorProxyRo<Container, max_resize, min_resize>::completion_patch(String &path, String &entry, int &offset)
   {
@@ -147,7 +222,7 @@ namespace QtLua {
       QTLUA_THROW(QtLua::QVectorProxy, "Can not write to a null vector.");
 
     bool has_resize = max_resize > min_resize;
-    int index = (unsigned int)key.to_number() - 1;
+    int index = (unsigned int)key.to_integer() - 1;
 
     if (index < 0)
       goto oob;
@@ -186,6 +261,10 @@ namespace QtLua {
     if (!_vector)
       QTLUA_THROW(QtLua::QVectorProxy, "Can not iterate on a null vector.");
 
+    // iterate on a read only proxy to an implicitly shared copy
+    if (_snapshot)
+      return QTLUA_REFNEW(ProxyIterator, ls, QTLUA_REFNEW(SnapshotProxy, *_vector));
+
     return QTLUA_REFNEW(ProxyIterator, ls, *this);
   }
 
@@ -224,7 +303,19 @@ namespace QtLua {
   template <class Container, unsigned max_resize, unsigned min_resize>
   ValueRef QVectorProxyRo<Container, max_resize, min_resize>::ProxyIterator::get_value_ref()
   {
-    return ValueRef(Value(_ls, _proxy), Value(_ls, (double)_it + 1));
+    return ValueRef(Value(_ls, _proxy), Value(_ls, (int)_it + 1));
+  }
+
+  template <class Container, unsigned max_resize, unsigned min_resize>
+  int QVectorProxyRo<Container, max_resize, min_resize>::ProxyIterator::push_next(lua_State *st)
+  {
+    if (!more())
+      return 0;
+
+    push(st, _ls, (int)_it + 1);
+    push(st, _ls, _proxy->_vector->at(_it));
+    _it++;
+    return 2;
   }
 
 }
@@ -0,0 +1,86 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008-2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#ifndef QTLUARANGEMETHOD_HH_
+#define QTLUARANGEMETHOD_HH_
+
+#include "qtluafunction.hh"
+
+namespace QtLua {
+
+  /**
+   * @short Range access methods of indexed container proxies
+   * @module {Container proxies}
+   * @internal
+   *
+   * This class implements the @tt get, @tt set and @tt slice lua
+   * methods shared by indexed container proxies. These methods
+   * read or write a range of elements in a single call:
+   *
+   * @list
+   *   @item @tt{proxy:get(i [, n])} returns up to @tt n elements
+   *     starting at index @tt i as multiple values,
+   *   @item @tt{proxy:set(i, table)} writes elements of the table
+   *     starting at index @tt i,
+   *   @item @tt{proxy:slice(i [, j])} returns a lua table with a copy
+   *     of a sub range with the same index conventions as the lua
+   *     @tt{string.sub} function.
+   * @end list
+   *
+   * The @tt Proxy class must provide the @tt range_size, @tt
+   * range_max_size, @tt range_get, @tt range_push and @tt
+   * range_table functions. The @tt range_push function pushes
+   * elements directly on the lua stack when @tt get is called from
+   * lua. Writes are performed through the proxy @ref
+   * UserData::meta_newindex function once the whole range has been
+   * checked against the container size and resize bounds, so that
+   * an out of bounds @tt set does not modify the container.
+   */
+  template <class Proxy>
+  class RangeMethod : public Function
+  {
+  public:
+    /** @This returns the method object associated with a key or
+	@tt NULL if the key is not a range method name. */
+    static RangeMethod * get(const Value &key);
+
+  private:
+    enum Id
+      {
+	Get, Set, Slice
+      };
+
+    RangeMethod(Id id);
+
+    /** Compute the container range accessed by the @tt get method */
+    static void get_bounds(const Proxy &proxy, const Value::List &args, int &start, int &end);
+
+    Value::List meta_call(State *ls, const Value::List &args);
+    int meta_call_push(State *ls, lua_State *st, const Value::List &args);
+    String get_description() const;
+    String get_help() const;
+
+    Id _id;
+  };
+
+}
+
+#endif
+
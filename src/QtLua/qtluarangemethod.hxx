@@ -0,0 +1,197 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008-2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#ifndef QTLUARANGEMETHOD_HXX_
+#define QTLUARANGEMETHOD_HXX_
+
+#include <algorithm>
+
+#include "qtluafunction.hxx"
+
+namespace QtLua {
+
+  template <class Proxy>
+  RangeMethod<Proxy>::RangeMethod(Id id)
+    : _id(id)
+  {
+  }
+
+  template <class Proxy>
+  RangeMethod<Proxy> * RangeMethod<Proxy>::get(const Value &key)
+  {
+    static RangeMethod methods[] = {
+      RangeMethod(Get), RangeMethod(Set), RangeMethod(Slice)
+    };
+
+    if (key.type() != Value::TString)
+      return 0;
+
+    String name(key.to_string());
+
+    if (name == "get")
+      return methods + Get;
+    if (name == "set")
+      return methods + Set;
+    if (name == "slice")
+      return methods + Slice;
+
+    return 0;
+  }
+
+  template <class Proxy>
+  String RangeMethod<Proxy>::get_description() const
+  {
+    return "Container proxy range access method.";
+  }
+
+  template <class Proxy>
+  String RangeMethod<Proxy>::get_help() const
+  {
+    switch (_id)
+      {
+      case Get:
+	return "usage: proxy:get(i [, n])\n";
+      case Set:
+	return "usage: proxy:set(i, { value, ... })\n";
+      default:
+	return "usage: proxy:slice(i [, j])\n";
+      }
+  }
+
+  template <class Proxy>
+  void RangeMethod<Proxy>::get_bounds(const Proxy &proxy, const Value::List &args, int &start, int &end)
+  {
+    int size = proxy.range_size();
+
+    // negative index values are relative to the end of the container
+    int i = get_arg<int>(args, 1, 1);
+    if (i < 0)
+      i += size + 1;
+
+    start = i < 1 ? 0 : i - 1;
+    end = i - 1 + get_arg<int>(args, 2, 1);
+
+    if (end > size)
+      end = size;
+  }
+
+  template <class Proxy>
+  int RangeMethod<Proxy>::meta_call_push(State *ls, lua_State *st, const Value::List &args)
+  {
+    if (_id != Get)
+      return UserData::meta_call_push(ls, st, args);
+
+    Ref<Proxy> proxy = get_arg_ud<Proxy>(args, 0);
+    int start, end;
+
+    get_bounds(*proxy, args, start, end);
+
+    if (start >= end)
+      return 0;
+
+    if (!lua_checkstack(st, end - start))
+      QTLUA_THROW(QtLua::RangeMethod, "Unable to extend the lua stack to handle % return values",
+		  .arg(end - start));
+
+    proxy->range_push(st, ls, start, end - start);
+    return end - start;
+  }
+
+  template <class Proxy>
+  Value::List RangeMethod<Proxy>::meta_call(State *ls, const Value::List &args)
+  {
+    Ref<Proxy> proxy = get_arg_ud<Proxy>(args, 0);
+    int size = proxy->range_size();
+
+    // negative index values are relative to the end of the container
+    int i = get_arg<int>(args, 1, 1);
+    if (i < 0)
+      i += size + 1;
+
+    switch (_id)
+      {
+      case Get: {
+	int start, end;
+	Value::List res;
+
+	get_bounds(*proxy, args, start, end);
+
+	if (start < end)
+	  {
+	    res.reserve(end - start);
+	    proxy->range_get(ls, res, start, end - start);
+	  }
+
+	return res;
+      }
+
+      case Set: {
+	Value table = get_arg<const Value &>(args, 2);
+	int n = table.len();
+
+	// check the whole range before writing anything
+	if (i < 1)
+	  QTLUA_THROW(QtLua::RangeMethod, "Index `%' is out of bounds.", .arg(i));
+
+	if (n > std::max(size, proxy->range_max_size()) - i + 1)
+	  QTLUA_THROW(QtLua::RangeMethod, "Index `%' is out of bounds.", .arg(i + n - 1));
+
+	Value::List values;
+	values.reserve(n);
+
+	for (int k = 0; k < n; k++)
+	  {
+	    Value v(table.at(k + 1));
+
+	    if (v.is_nil())
+	      QTLUA_THROW(QtLua::RangeMethod, "Can not write a nil value at index `%'.", .arg(i + k));
+
+	    values.append(v);
+	  }
+
+	for (int k = 0; k < n; k++)
+	  proxy->meta_newindex(ls, Value(ls, i + k), values[k]);
+
+	return Value::List();
+      }
+
+      default: {
+	int j = get_arg<int>(args, 2, -1);
+	if (j < 0)
+	  j += size + 1;
+
+	if (i < 1)
+	  i = 1;
+	if (j > size)
+	  j = size;
+
+	// empty range, the container may be detached
+	if (i > j)
+	  return Value::new_table(ls);
+
+	return proxy->range_table(ls, i - 1, j - i + 1);
+      }
+      }
+  }
+
+}
+
+#endif
+
@@ -237,6 +237,17 @@ public:
    */
   inline void enable_qdebug_print(bool enabled = true);
 
+  /**
+   * @This function may be used to convert @ref QByteArray values to
+   * @ref Blob userdata objects sharing the byte array storage instead
+   * of copying data to lua strings.
+   */
+  inline void enable_bytearray_blob(bool enabled = true);
+
+  /** @This returns true if @ref QByteArray values are converted to
+      @ref Blob objects. @see enable_bytearray_blob */
+  inline bool is_bytearray_blob_enabled() const;
+
 public slots:
 
   /**
@@ -266,6 +277,11 @@ signals:
    */
   void output(const QString &str);
 
+private slots:
+
+  // wrapped QObjects destruction notification
+  void qobject_destroyed(QObject *obj);
+
 private:
 
   inline void output_str(const String &str);
@@ -295,6 +311,8 @@ private:
   static int lua_cmd_plugin(lua_State *st);
   static int lua_cmd_qtype(lua_State *st);
 
+  static void open_base(lua_State *st);
+
   // lua meta methods functions
   static int lua_meta_item_add(lua_State *st);
   static int lua_meta_item_sub(lua_State *st);
@@ -317,6 +335,7 @@ private:
   static char _key_threads;
   static char _key_item_metatable;
   static char _key_this;
+  static char _key_next;
 
   // QObjects wrappers are referenced here
   wrapper_hash_t _whash;
@@ -325,6 +344,7 @@ private:
   lua_State	*_lst;      //< current thread state
   bool          _yield_on_return;
   bool          _debug_output;
+  bool          _bytearray_blob;
 };
 
 }
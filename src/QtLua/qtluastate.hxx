@@ -74,6 +74,16 @@ namespace QtLua {
     _debug_output = enabled;
   }
 
+  void State::enable_bytearray_blob(bool enabled)
+  {
+    _bytearray_blob = enabled;
+  }
+
+  bool State::is_bytearray_blob_enabled() const
+  {
+    return _bytearray_blob;
+  }
+
 }
 
 #endif
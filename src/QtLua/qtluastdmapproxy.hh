@@ -0,0 +1,216 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008-2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#ifndef QTLUASTDMAPPROXY_HH_
+#define QTLUASTDMAPPROXY_HH_
+
+#include <string>
+
+#if __cplusplus >= 201103L
+# include <functional>
+# include <type_traits>
+#endif
+
+#include <QPointer>
+#include <QHash>
+
+#include "qtluauserdata.hh"
+#include "qtluaiterator.hh"
+#include "qtluaqhashproxy.hh"
+
+namespace QtLua {
+
+  /** @module {Container proxies} @internal */
+  template <typename T>
+  struct StdMapProxyKeytype : public QHashProxyKeytype<T>
+  {
+    /** Get a key value suitable for lua value construction */
+    static inline const T & to_lua(const T &key);
+    /** Get a key suitable for insertion in the container */
+    static inline T from_lua(const Value &key);
+  };
+
+  /** @module {Container proxies} @internal */
+  template <>
+  struct StdMapProxyKeytype<std::string>
+  {
+    static inline void completion_patch(String &path, String &entry, int &offset);
+    static inline String to_lua(const std::string &key);
+    static inline std::string from_lua(const Value &key);
+    static inline std::string lookup_key(const Value &key);
+  };
+
+  /** @module {Container proxies} @internal Container lookup from a lua key */
+  template <class Container, typename Enable = void>
+  struct StdMapProxyLookup
+  {
+    static inline typename Container::iterator find(Container &map, const Value &key);
+  };
+
+#if __cplusplus >= 201703L
+  /** @module {Container proxies} @internal Lookup in @tt std::string
+      keyed containers with a transparent comparator, the lua string
+      bytes are used without copy. */
+  template <class Container>
+  struct StdMapProxyLookup<Container, typename std::enable_if<
+    std::is_same<typename Container::key_type, std::string>::value,
+    std::void_t<typename Container::key_compare::is_transparent> >::type>
+  {
+    static inline typename Container::iterator find(Container &map, const Value &key);
+  };
+#endif
+
+  /**
+   * @short std::map and std::unordered_map read only access wrapper for lua script
+   * @header QtLua/StdMapProxy
+   * @module {Container proxies}
+   *
+   * This template class may be used to expose an attached @tt
+   * std::map or @tt std::unordered_map container object to lua
+   * script for read access. The @ref StdMapProxy class may be used
+   * for read/write access.
+   *
+   * See @ref StdMapProxy class documentation for details.
+   */
+
+template <class Container>
+class StdMapProxyRo : public UserData
+{
+public:
+  QTLUA_REFTYPE(StdMapProxyRo);
+
+  /** Create a @ref StdMapProxy object with no attached container */
+  StdMapProxyRo();
+  /** Create a @ref StdMapProxy object and attach given container */
+  StdMapProxyRo(Container &map);
+
+  /** Attach or detach container. argument may be NULL */
+  void set_container(Container *map);
+
+  Value meta_index(State *ls, const Value &key);
+  bool meta_contains(State *ls, const Value &key);
+  bool meta_try_index(State *ls, const Value &key, Value &value);
+  Ref<Iterator> new_iterator(State *ls);
+  Value meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b);
+  bool support(Value::Operation c) const;
+
+private:
+  void completion_patch(String &path, String &entry, int &offset);
+  String get_type_name() const;
+
+  /**
+   * @short StdMapProxyRo iterator class
+   * @internal
+   */
+  class ProxyIterator : public Iterator
+  {
+  public:
+    QTLUA_REFTYPE(ProxyIterator);
+    ProxyIterator(State *ls, const Ref<StdMapProxyRo> &proxy);
+
+  private:
+    bool more() const;
+    void next();
+    Value get_key() const;
+    Value get_value() const;
+    ValueRef get_value_ref();
+    int push_next(lua_State *st);
+
+    QPointer<State> _ls;
+    Ref<StdMapProxyRo> _proxy;
+    typename Container::iterator _it;
+  };
+
+protected:
+  /** @internal */
+  Container *_map;
+};
+
+  /**
+   * @short std::map and std::unordered_map access wrapper for lua script
+   * @header QtLua/StdMapProxy
+   * @module {Container proxies}
+   *
+   * This template class may be used to expose an attached @tt
+   * std::map or @tt std::unordered_map container object to lua
+   * script for read and write access. The @ref StdMapProxyRo class
+   * may be used for read only access. No copy of the container is
+   * involved, lua accesses the live C++ data.
+   *
+   * Containers may be attached and detached from the wrapper object
+   * to solve cases where we want to destroy the container when lua
+   * still holds references to the wrapper object. When no container
+   * is attached access will raise an error.
+   *
+   * Lua @tt nil value is returned if no such entry exists on table
+   * read. A @tt nil value write will delete entry at access index.
+   *
+   * When the container is indexed with @ref String keys, lookups
+   * share the lua string buffer instead of copying the key. Keys are
+   * only copied when a new entry is inserted. A @tt std::hash
+   * specialization is provided so that @ref String keys can be used
+   * with @tt std::unordered_map.
+   *
+   * @tt std::string keys are supported as well. Lookups in a @tt
+   * std::map with a transparent comparator such as @tt{std::less<>}
+   * use the lua string bytes directly when compiled as C++17, other
+   * containers need a copy of the key.
+   *
+   * Lua operator @tt # returns the container entry count. Lua
+   * operator @tt - returns a lua table copy of the container.
+   */
+
+template <class Container>
+class StdMapProxy : public StdMapProxyRo<Container>
+{
+  using StdMapProxyRo<Container>::_map;
+
+public:
+  QTLUA_REFTYPE(StdMapProxy);
+
+  /** Create a @ref StdMapProxy object */
+  StdMapProxy();
+  /** Create a @ref StdMapProxy object */
+  StdMapProxy(Container &map);
+
+  void meta_newindex(State *ls, const Value &key, const Value &value);
+  bool support(Value::Operation c) const;
+};
+
+}
+
+#if __cplusplus >= 201103L
+namespace std {
+
+  /** @internal */
+  template <>
+  struct hash<QtLua::String>
+  {
+    size_t operator()(const QtLua::String &s) const
+    {
+      return qHash(s);
+    }
+  };
+
+}
+#endif
+
+#endif
+
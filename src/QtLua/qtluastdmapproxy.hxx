@@ -0,0 +1,300 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008-2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#ifndef QTLUASTDMAPPROXY_HXX_
+#define QTLUASTDMAPPROXY_HXX_
+
+#include "qtluauserdata.hxx"
+#include "qtluaiterator.hxx"
+#include "qtluaqhashproxy.hxx"
+
+#if __cplusplus >= 201703L
+# include <string_view>
+#endif
+
+namespace QtLua {
+
+  template <typename T>
+  const T & StdMapProxyKeytype<T>::to_lua(const T &key)
+  {
+    return key;
+  }
+
+  template <typename T>
+  T StdMapProxyKeytype<T>::from_lua(const Value &key)
+  {
+    return key;
+  }
+
+  void StdMapProxyKeytype<std::string>::completion_patch(String &path, String &entry, int &offset)
+  {
+    entry += ".";
+  }
+
+  String StdMapProxyKeytype<std::string>::to_lua(const std::string &key)
+  {
+    return String(key.data(), key.size());
+  }
+
+  std::string StdMapProxyKeytype<std::string>::from_lua(const Value &key)
+  {
+    String s(key.to_string_ref());
+    return std::string(s.constData(), s.size());
+  }
+
+  std::string StdMapProxyKeytype<std::string>::lookup_key(const Value &key)
+  {
+    return from_lua(key);
+  }
+
+  template <class Container, typename Enable>
+  typename Container::iterator StdMapProxyLookup<Container, Enable>::find(Container &map, const Value &key)
+  {
+    return map.find(StdMapProxyKeytype<typename Container::key_type>::lookup_key(key));
+  }
+
+#if __cplusplus >= 201703L
+  template <class Container>
+  typename Container::iterator StdMapProxyLookup<Container, typename std::enable_if<
+    std::is_same<typename Container::key_type, std::string>::value,
+    std::void_t<typename Container::key_compare::is_transparent> >::type>
+  ::find(Container &map, const Value &key)
+  {
+    // the string buffer is kept alive by the lua value during lookup
+    String s(key.to_string_ref());
+    return map.find(std::string_view(s.constData(), s.size()));
+  }
+#endif
+
+  template <class Container>
+  StdMapProxyRo<Container>::StdMapProxyRo()
+    : _map(0)
+  {
+  }
+
+  template <class Container>
+  StdMapProxyRo<Container>::StdMapProxyRo(Container &map)
+    : _map(&map)
+  {
+  }
+
+  template <class Container>
+  StdMapProxy<Container>::StdMapProxy()
+    : StdMapProxyRo<Container>()
+  {
+  }
+
+  template <class Container>
+  StdMapProxy<Container>::StdMapProxy(Container &map)
+    : StdMapProxyRo<Container>(map)
+  {
+  }
+
+  template <class Container>
+  void StdMapProxyRo<Container>::set_container(Container *map)
+  {
+    _map = map;
+  }
+
+  template <class Container>
+  Value StdMapProxyRo<Container>::meta_index(State *ls, const Value &key)
+  {
+    if (!_map)
+      return Value(ls);
+
+    typename Container::const_iterator i = StdMapProxyLookup<Container>::find(*_map, key);
+
+    if (i == _map->end())
+      return Value(ls);
+    else
+      return Value(ls, i->second);
+  }
+
+  template <class Container>
+  bool StdMapProxyRo<Container>::meta_contains(State *ls, const Value &key)
+  {
+    return _map && StdMapProxyLookup<Container>::find(*_map, key) != _map->end();
+  }
+
+  template <class Container>
+  bool StdMapProxyRo<Container>::meta_try_index(State *ls, const Value &key, Value &value)
+  {
+    if (!_map)
+      return false;
+
+    typename Container::const_iterator i = StdMapProxyLookup<Container>::find(*_map, key);
+
+    if (i == _map->end())
+      return false;
+
+    value = Value(ls, i->second);
+    return true;
+  }
+
+  template <class Container>
+  Value StdMapProxyRo<Container>::meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b)
+  {
+    switch (op)
+      {
+      case Value::OpLen:
+	return Value(ls, _map ? (unsigned int)_map->size() : 0);
+      case Value::OpUnm: {
+	if (!_map)
+	  return Value(ls);
+
+	Value table(Value::new_table(ls));
+
+	for (typename Container::const_iterator i = _map->begin(); i != _map->end(); i++)
+	  table[Value(ls, StdMapProxyKeytype<typename Container::key_type>::to_lua(i->first))]
+	    = Value(ls, i->second);
+
+	return table;
+      }
+      default:
+	return UserData::meta_operation(ls, op, a, b);
+      }
+  }
+
+  template <class Container>
+  bool StdMapProxyRo<Container>::support(Value::Operation c) const
+  {
+    switch (c)
+      {
+      case Value::OpIndex:
+      case Value::OpIterate:
+      case Value::OpLen:
+      case Value::OpUnm:
+	return true;
+      default:
+	return false;
+      }
+  }
+
+  template <class Container>
+  bool StdMapProxy<Container>::support(Value::Operation c) const
+  {
+    return c == Value::OpNewindex || StdMapProxyRo<Container>::support(c);
+  }
+
+  template <class Container>
+  void StdMapProxy<Container>::meta_newindex(State *ls, const Value &key, const Value &value)
+  {
+    if (!_map)
+      QTLUA_THROW(QtLua::StdMapProxy, "Can not index a null container.");
+
+    typename Container::iterator i = StdMapProxyLookup<Container>::find(*_map, key);
+
+    if (value.type() == Value::TNil)
+      {
+	if (i != _map->end())
+	  _map->erase(i);
+	return;
+      }
+
+    typename Container::mapped_type v = value;
+
+    if (i != _map->end())
+      {
+	i->second = v;
+      }
+    else
+      {
+	typename Container::key_type k
+	  = StdMapProxyKeytype<typename Container::key_type>::from_lua(key);
+	_map->insert(typename Container::value_type(k, v));
+      }
+  }
+
+  template <class Container>
+  Ref<Iterator> StdMapProxyRo<Container>::new_iterator(State *ls)
+  {
+    if (!_map)
+      QTLUA_THROW(QtLua::StdMapProxyRo, "Can not iterate on a null container.");
+
+    return QTLUA_REFNEW(ProxyIterator, ls, *this);
+  }
+
+  template <class Container>
+  StdMapProxyRo<Container>::ProxyIterator::ProxyIterator(State *ls, const Ref<StdMapProxyRo> &proxy)
+    : _ls(ls),
+      _proxy(proxy),
+      _it(_proxy->_map->begin())
+  {
+  }
+
+  template <class Container>
+  bool StdMapProxyRo<Container>::ProxyIterator::more() const
+  {
+    return _proxy->_map && _it != _proxy->_map->end();
+  }
+
+  template <class Container>
+  void StdMapProxyRo<Container>::ProxyIterator::next()
+  {
+    _it++;
+  }
+
+  template <class Container>
+  Value StdMapProxyRo<Container>::ProxyIterator::get_key() const
+  {
+    return Value(_ls, StdMapProxyKeytype<typename Container::key_type>::to_lua(_it->first));
+  }
+
+  template <class Container>
+  Value StdMapProxyRo<Container>::ProxyIterator::get_value() const
+  {
+    return Value(_ls, _it->second);
+  }
+
+  template <class Container>
+  ValueRef StdMapProxyRo<Container>::ProxyIterator::get_value_ref()
+  {
+    return ValueRef(Value(_ls, _proxy),
+		    Value(_ls, StdMapProxyKeytype<typename Container::key_type>::to_lua(_it->first)));
+  }
+
+  template <class Container>
+  int StdMapProxyRo<Container>::ProxyIterator::push_next(lua_State *st)
+  {
+    if (!more())
+      return 0;
+
+    push(st, _ls, StdMapProxyKeytype<typename Container::key_type>::to_lua(_it->first));
+    push(st, _ls, _it->second);
+    _it++;
+    return 2;
+  }
+
+  template <class Container>
+  void StdMapProxyRo<Container>::completion_patch(String &path, String &entry, int &offset)
+  {
+    StdMapProxyKeytype<typename Container::key_type>::completion_patch(path, entry, offset);
+  }
+
+  template <class Container>
+  String StdMapProxyRo<Container>::get_type_name() const
+  {
+    return type_name<Container>();
+  }
+
+}
+
+#endif
+
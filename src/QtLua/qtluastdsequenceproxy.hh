@@ -0,0 +1,307 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008-2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#ifndef QTLUASTDSEQUENCEPROXY_HH_
+#define QTLUASTDSEQUENCEPROXY_HH_
+
+#include <QPointer>
+
+#include "qtluauserdata.hh"
+#include "qtluaiterator.hh"
+#include "qtluarangemethod.hh"
+
+namespace QtLua {
+
+  /**
+   * @short Element access policy for contiguous STL containers
+   * @header QtLua/StdVectorProxy
+   * @module {Container proxies}
+   * @internal
+   *
+   * Elements are accessed through the pointer returned by the @tt
+   * data() function of the container.
+   */
+  template <class Container>
+  struct StdContiguousAccess
+  {
+    static inline const typename Container::value_type & at(const Container &c, unsigned int index);
+    static inline void range_get(State *ls, Value::List &list, const Container &c, int offset, int count);
+    static inline void range_push(lua_State *st, State *ls, const Container &c, int offset, int count);
+    static inline Value range_table(State *ls, const Container &c, int offset, int count);
+  };
+
+  /**
+   * @short Element access policy for random access STL containers
+   * @header QtLua/StdDequeProxy
+   * @module {Container proxies}
+   * @internal
+   *
+   * Elements are accessed through the container random access
+   * iterators.
+   */
+  template <class Container>
+  struct StdIteratorAccess
+  {
+    static inline const typename Container::value_type & at(const Container &c, unsigned int index);
+    static inline void range_get(State *ls, Value::List &list, const Container &c, int offset, int count);
+    static inline void range_push(lua_State *st, State *ls, const Container &c, int offset, int count);
+    static inline Value range_table(State *ls, const Container &c, int offset, int count);
+  };
+
+  /**
+   * @short STL sequence read only access wrapper for lua script
+   * @header QtLua/StdVectorProxy
+   * @module {Container proxies}
+   *
+   * This template class may be used to expose an attached STL
+   * sequence container object to lua script for read access. The
+   * @ref StdSequenceProxy class may be used for read/write access.
+   *
+   * The @tt Access policy class is used to read container elements,
+   * see @ref StdVectorProxyRo and @ref StdDequeProxyRo.
+   *
+   * The container may be resized if accessing above current size,
+   * depending on @tt max_resize template parameter value. Resize
+   * above specified value is not allowed.
+   *
+   * See @ref StdSequenceProxy class documentation for details.
+   */
+
+template <class Container,
+	  class Access,
+	  unsigned int max_resize = 0,
+	  unsigned int min_resize = 0>
+class StdSequenceProxyRo : public UserData
+{
+public:
+  QTLUA_REFTYPE(StdSequenceProxyRo);
+
+  /** Create a @ref StdSequenceProxy object with no attached container */
+  StdSequenceProxyRo();
+  /** Create a @ref StdSequenceProxy object and attach given container */
+  StdSequenceProxyRo(Container &seq);
+
+  /** Attach or detach container. argument may be NULL */
+  void set_container(Container *seq);
+
+  Value meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b);
+  Value meta_index(State *ls, const Value &key);
+  bool meta_contains(State *ls, const Value &key);
+  bool meta_try_index(State *ls, const Value &key, Value &value);
+  Ref<Iterator> new_iterator(State *ls);
+  bool support(Value::Operation c) const;
+
+private:
+  void completion_patch(String &path, String &entry, int &offset);
+  String get_type_name() const;
+
+  friend class RangeMethod<StdSequenceProxyRo>;
+  int range_size() const;
+  int range_max_size() const;
+  void range_get(State *ls, Value::List &list, int offset, int count) const;
+  void range_push(lua_State *st, State *ls, int offset, int count) const;
+  Value range_table(State *ls, int offset, int count) const;
+
+  /**
+   * @short StdSequenceProxyRo iterator class
+   * @internal
+   */
+  class ProxyIterator : public Iterator
+  {
+  public:
+    QTLUA_REFTYPE(ProxyIterator);
+    ProxyIterator(State *ls, const Ref<StdSequenceProxyRo> &proxy);
+
+  private:
+    bool more() const;
+    void next();
+    Value get_key() const;
+    Value get_value() const;
+    ValueRef get_value_ref();
+    int push_next(lua_State *st);
+
+    QPointer<State> _ls;
+    Ref<StdSequenceProxyRo> _proxy;
+    unsigned int _it;
+  };
+
+protected:
+  Container *_seq;
+};
+
+  /**
+   * @short STL sequence access wrapper for lua script
+   * @header QtLua/StdVectorProxy
+   * @module {Container proxies}
+   *
+   * This template class may be used to expose an attached STL
+   * sequence container object to lua script for read and write
+   * access. The @ref StdSequenceProxyRo class may be used for read
+   * only access. No copy of the container is involved, lua accesses
+   * the live C++ data. The @ref StdVectorProxy and @ref
+   * StdDequeProxy classes select the appropriate @tt Access policy.
+   *
+   * Containers may be attached and detached from the wrapper object
+   * to solve cases where we want to destroy the container when lua
+   * still holds references to the wrapper object. When no container
+   * is attached access will raise an error.
+   *
+   * First entry has index 1. Lua @tt nil value is returned when
+   * reading above container size. Write access above current size
+   * increase container size as long as the new size is not higher
+   * than @tt max_resize. Writing a @tt nil value truncates container
+   * by discarding value at accessed index and all values at higher
+   * indexes provided that the new size is not lower than @tt min_resize.
+   *
+   * Lua operator @tt # returns the container entry count. Lua
+   * operator @tt - returns a lua table copy of the container.
+   *
+   * Iterators access the live container by index and stop at the
+   * current end of the container, modifying the container from C++
+   * during iteration is allowed.
+   *
+   * The @tt get, @tt set and @tt slice range methods are available
+   * as described for the @ref QVectorProxy class.
+   */
+
+template <class Container,
+	  class Access,
+	  unsigned int max_resize = 0,
+	  unsigned int min_resize = 0>
+class StdSequenceProxy : public StdSequenceProxyRo<Container, Access, max_resize, min_resize>
+{
+  using StdSequenceProxyRo<Container, Access, max_resize, min_resize>::_seq;
+
+public:
+  QTLUA_REFTYPE(StdSequenceProxy);
+
+  /** Create a @ref StdSequenceProxy object */
+  StdSequenceProxy();
+  /** Create a @ref StdSequenceProxy object */
+  StdSequenceProxy(Container &seq);
+
+  void meta_newindex(State *ls, const Value &key, const Value &value);
+  bool support(Value::Operation c) const;
+};
+
+  /**
+   * @short std::vector read only access wrapper for lua script
+   * @header QtLua/StdVectorProxy
+   * @module {Container proxies}
+   *
+   * This template class exposes a @tt std::vector container for read
+   * access. Elements are read directly from the contiguous vector
+   * storage. See @ref StdSequenceProxy class documentation for
+   * details.
+   */
+template <class Container,
+	  unsigned int max_resize = 0,
+	  unsigned int min_resize = 0>
+class StdVectorProxyRo
+  : public StdSequenceProxyRo<Container, StdContiguousAccess<Container>, max_resize, min_resize>
+{
+public:
+  QTLUA_REFTYPE(StdVectorProxyRo);
+
+  /** Create a @ref StdVectorProxyRo object */
+  inline StdVectorProxyRo();
+  /** Create a @ref StdVectorProxyRo object */
+  inline StdVectorProxyRo(Container &vector);
+};
+
+  /**
+   * @short std::vector access wrapper for lua script
+   * @header QtLua/StdVectorProxy
+   * @module {Container proxies}
+   *
+   * This template class exposes a @tt std::vector container for
+   * read and write access. Elements are read directly from the
+   * contiguous vector storage. See @ref StdSequenceProxy class
+   * documentation for details.
+   */
+template <class Container,
+	  unsigned int max_resize = 0,
+	  unsigned int min_resize = 0>
+class StdVectorProxy
+  : public StdSequenceProxy<Container, StdContiguousAccess<Container>, max_resize, min_resize>
+{
+public:
+  QTLUA_REFTYPE(StdVectorProxy);
+
+  /** Create a @ref StdVectorProxy object */
+  inline StdVectorProxy();
+  /** Create a @ref StdVectorProxy object */
+  inline StdVectorProxy(Container &vector);
+};
+
+  /**
+   * @short std::deque read only access wrapper for lua script
+   * @header QtLua/StdDequeProxy
+   * @module {Container proxies}
+   *
+   * This template class exposes a @tt std::deque container for read
+   * access. The deque storage is not contiguous, ranges are walked
+   * with container iterators. See @ref StdSequenceProxy class
+   * documentation for details.
+   */
+template <class Container,
+	  unsigned int max_resize = 0,
+	  unsigned int min_resize = 0>
+class StdDequeProxyRo
+  : public StdSequenceProxyRo<Container, StdIteratorAccess<Container>, max_resize, min_resize>
+{
+public:
+  QTLUA_REFTYPE(StdDequeProxyRo);
+
+  /** Create a @ref StdDequeProxyRo object */
+  inline StdDequeProxyRo();
+  /** Create a @ref StdDequeProxyRo object */
+  inline StdDequeProxyRo(Container &deque);
+};
+
+  /**
+   * @short std::deque access wrapper for lua script
+   * @header QtLua/StdDequeProxy
+   * @module {Container proxies}
+   *
+   * This template class exposes a @tt std::deque container for read
+   * and write access. The deque storage is not contiguous, ranges are
+   * walked with container iterators. See @ref StdSequenceProxy class
+   * documentation for details.
+   */
+template <class Container,
+	  unsigned int max_resize = 0,
+	  unsigned int min_resize = 0>
+class StdDequeProxy
+  : public StdSequenceProxy<Container, StdIteratorAccess<Container>, max_resize, min_resize>
+{
+public:
+  QTLUA_REFTYPE(StdDequeProxy);
+
+  /** Create a @ref StdDequeProxy object */
+  inline StdDequeProxy();
+  /** Create a @ref StdDequeProxy object */
+  inline StdDequeProxy(Container &deque);
+};
+
+}
+
+#endif
+
@@ -0,0 +1,407 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008-2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#ifndef QTLUASTDSEQUENCEPROXY_HXX_
+#define QTLUASTDSEQUENCEPROXY_HXX_
+
+#include "qtluauserdata.hxx"
+#include "qtluaiterator.hxx"
+#include "qtluarangemethod.hxx"
+
+namespace QtLua {
+
+  template <class Container>
+  const typename Container::value_type & StdContiguousAccess<Container>::at(const Container &c, unsigned int index)
+  {
+    return c.data()[index];
+  }
+
+  template <class Container>
+  void StdContiguousAccess<Container>::range_get(State *ls, Value::List &list, const Container &c, int offset, int count)
+  {
+    const typename Container::value_type *p = c.data() + offset;
+
+    for (int i = 0; i < count; i++)
+      list.append(Value(ls, p[i]));
+  }
+
+  template <class Container>
+  void StdContiguousAccess<Container>::range_push(lua_State *st, State *ls, const Container &c, int offset, int count)
+  {
+    const typename Container::value_type *p = c.data() + offset;
+
+    for (int i = 0; i < count; i++)
+      Iterator::push(st, ls, p[i]);
+  }
+
+  template <class Container>
+  Value StdContiguousAccess<Container>::range_table(State *ls, const Container &c, int offset, int count)
+  {
+    return Value(ls, (unsigned int)count, c.data() + offset);
+  }
+
+  template <class Container>
+  const typename Container::value_type & StdIteratorAccess<Container>::at(const Container &c, unsigned int index)
+  {
+    return c[index];
+  }
+
+  template <class Container>
+  void StdIteratorAccess<Container>::range_get(State *ls, Value::List &list, const Container &c, int offset, int count)
+  {
+    typename Container::const_iterator it = c.begin() + offset;
+
+    for (int i = 0; i < count; i++)
+      list.append(Value(ls, *it++));
+  }
+
+  template <class Container>
+  void StdIteratorAccess<Container>::range_push(lua_State *st, State *ls, const Container &c, int offset, int count)
+  {
+    typename Container::const_iterator it = c.begin() + offset;
+
+    for (int i = 0; i < count; i++)
+      Iterator::push(st, ls, *it++);
+  }
+
+  template <class Container>
+  Value StdIteratorAccess<Container>::range_table(State *ls, const Container &c, int offset, int count)
+  {
+    Value table(Value::new_table(ls));
+    typename Container::const_iterator it = c.begin() + offset;
+
+    for (int i = 0; i < count; i++)
+      table[i + 1] = *it++;
+
+    return table;
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  StdSequenceProxyRo<Container, Access, max_resize, min_resize>::StdSequenceProxyRo()
+    : _seq(0)
+  {
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  StdSequenceProxyRo<Container, Access, max_resize, min_resize>::StdSequenceProxyRo(Container &seq)
+    : _seq(&seq)
+  {
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  StdSequenceProxy<Container, Access, max_resize, min_resize>::StdSequenceProxy()
+    : StdSequenceProxyRo<Container, Access, max_resize, min_resize>()
+  {
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  StdSequenceProxy<Container, Access, max_resize, min_resize>::StdSequenceProxy(Container &seq)
+    : StdSequenceProxyRo<Container, Access, max_resize, min_resize>(seq)
+  {
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  void StdSequenceProxyRo<Container, Access, max_resize, min_resize>::set_container(Container *seq)
+  {
+    _seq = seq;
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  Value StdSequenceProxyRo<Container, Access, max_resize, min_resize>::meta_index(State *ls, const Value &key)
+  { 
+    if (RangeMethod<StdSequenceProxyRo> *m = RangeMethod<StdSequenceProxyRo>::get(key))
+      return Value(ls, m);
+
+    if (!_seq)
+      return Value(ls);
+
+    unsigned int index = (unsigned int)key.to_integer() - 1;
+
+    if (index < _seq->size())
+      return Value(ls, Access::at(*_seq, index));
+    else
+      return Value(ls);
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  bool StdSequenceProxyRo<Container, Access, max_resize, min_resize>::meta_contains(State *ls, const Value &key)
+  {
+    try {
+      unsigned int index = (unsigned int)key.to_integer() - 1;
+
+      return _seq && index < _seq->size();
+    } catch (String &e) {
+      return false;
+    }
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  bool StdSequenceProxyRo<Container, Access, max_resize, min_resize>::meta_try_index(State *ls, const Value &key, Value &value)
+  {
+    if (!_seq)
+      return false;
+
+    unsigned int index;
+
+    try {
+      index = (unsigned int)key.to_integer() - 1;
+    } catch (String &e) {
+      return false;
+    }
+
+    if (index >= _seq->size())
+      return false;
+
+    value = Value(ls, Access::at(*_seq, index));
+    return true;
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  Value StdSequenceProxyRo<Container, Access, max_resize, min_resize>::meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b)
+  {
+    switch (op)
+      {
+      case Value::OpLen:
+	return Value(ls, _seq ? (unsigned int)_seq->size() : 0);
+      case Value::OpUnm:
+	return _seq ? range_table(ls, 0, range_size()) : Value(ls);
+      default:
+	return UserData::meta_operation(ls, op, a, b);
+      }
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  bool StdSequenceProxyRo<Container, Access, max_resize, min_resize>::support(Value::Operation c) const
+  {
+    switch (c)
+      {
+      case Value::OpIndex:
+      case Value::OpIterate:
+      case Value::OpLen:
+      case Value::OpUnm:
+	return true;
+      default:
+	return false;
+      }
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  bool StdSequenceProxy<Container, Access, max_resize, min_resize>::support(Value::Operation c) const
+  {
+    return c == Value::OpNewindex || StdSequenceProxyRo<Container, Access, max_resize, min_resize>::support(c);
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  String StdSequenceProxyRo<Container, Access, max_resize, min_resize>::get_type_name() const
+  {
+    return type_name<Container>();
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  int StdSequenceProxyRo<Container, Access, max_resize, min_resize>::range_size() const
+  {
+    return _seq ? (int)_seq->size() : 0;
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  int StdSequenceProxyRo<Container, Access, max_resize, min_resize>::range_max_size() const
+  {
+    bool has_resize = max_resize > min_resize;
+    int size = range_size();
+
+    return has_resize && (int)max_resize > size ? (int)max_resize : size;
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  void StdSequenceProxyRo<Container, Access, max_resize, min_resize>::range_get(State *ls, Value::List &list, int offset, int count) const
+  {
+    Access::range_get(ls, list, *_seq, offset, count);
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  void StdSequenceProxyRo<Container, Access, max_resize, min_resize>::range_push(lua_State *st, State *ls, int offset, int count) const
+  {
+    Access::range_push(st, ls, *_seq, offset, count);
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  Value StdSequenceProxyRo<Container, Access, max_resize, min_resize>::range_table(State *ls, int offset, int count) const
+  {
+    return Access::range_table(ls, *_seq, offset, count);
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  void StdSequenceProxyRo<Container, Access, max_resize, min_resize>::completion_patch(String &path, String &entry, int &offset)
+  {
+    entry += "[]";
+    offset--;
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  void StdSequenceProxy<Container, Access, max_resize, min_resize>::meta_newindex(State *ls, const Value &key, const Value &value)
+  {
+    if (!_seq)
+      QTLUA_THROW(QtLua::StdSequenceProxy, "Can not write to a null container.");
+
+    bool has_resize = max_resize > min_resize;
+    int index = (unsigned int)key.to_integer() - 1;
+
+    if (index < 0)
+      goto oob;
+
+    if (has_resize && value.type() == Value::TNil)
+      {
+	if ((unsigned int)index < min_resize)
+	  QTLUA_THROW(QtLua::StdSequenceProxy, "Can not reduce container size below %.", .arg((int)min_resize));
+	if ((unsigned int)index < _seq->size())
+	  _seq->resize(index);
+      }
+    else
+      {
+	if ((unsigned int)index >= _seq->size())
+	  {
+	    if (has_resize)
+	      {
+		if ((unsigned int)index >= max_resize)
+		  QTLUA_THROW(QtLua::StdSequenceProxy, "Can not increase container size above %.", .arg((int)max_resize));
+		_seq->resize(index + 1);
+	      }
+	    else
+	      goto oob;
+	  }
+	(*_seq)[index] = value;
+      }
+
+    return;
+  oob:
+    QTLUA_THROW(QtLua::StdSequenceProxy, "Index `%' is out of bounds.", .arg(index));
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  Ref<Iterator> StdSequenceProxyRo<Container, Access, max_resize, min_resize>::new_iterator(State *ls)
+  {
+    if (!_seq)
+      QTLUA_THROW(QtLua::StdSequenceProxy, "Can not iterate on a null container.");
+
+    return QTLUA_REFNEW(ProxyIterator, ls, *this);
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  StdSequenceProxyRo<Container, Access, max_resize, min_resize>::ProxyIterator::ProxyIterator(State *ls, const Ref<StdSequenceProxyRo> &proxy)
+    : _ls(ls),
+      _proxy(proxy),
+      _it(0)
+  {
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  bool StdSequenceProxyRo<Container, Access, max_resize, min_resize>::ProxyIterator::more() const
+  {
+    return _proxy->_seq && _it < _proxy->_seq->size();
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  void StdSequenceProxyRo<Container, Access, max_resize, min_resize>::ProxyIterator::next()
+  {
+    _it++;
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  Value StdSequenceProxyRo<Container, Access, max_resize, min_resize>::ProxyIterator::get_key() const
+  {
+    return Value(_ls, (int)_it + 1);
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  Value StdSequenceProxyRo<Container, Access, max_resize, min_resize>::ProxyIterator::get_value() const
+  {
+    return Value(_ls, Access::at(*_proxy->_seq, _it));
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  ValueRef StdSequenceProxyRo<Container, Access, max_resize, min_resize>::ProxyIterator::get_value_ref()
+  {
+    return ValueRef(Value(_ls, _proxy), Value(_ls, (int)_it + 1));
+  }
+
+  template <class Container, class Access, unsigned max_resize, unsigned min_resize>
+  int StdSequenceProxyRo<Container, Access, max_resize, min_resize>::ProxyIterator::push_next(lua_State *st)
+  {
+    if (!more())
+      return 0;
+
+    push(st, _ls, (int)_it + 1);
+    push(st, _ls, Access::at(*_proxy->_seq, _it));
+    _it++;
+    return 2;
+  }
+
+  template <class Container, unsigned max_resize, unsigned min_resize>
+  StdVectorProxyRo<Container, max_resize, min_resize>::StdVectorProxyRo()
+    : StdSequenceProxyRo<Container, StdContiguousAccess<Container>, max_resize, min_resize>()
+  {
+  }
+
+  template <class Container, unsigned max_resize, unsigned min_resize>
+  StdVectorProxyRo<Container, max_resize, min_resize>::StdVectorProxyRo(Container &vector)
+    : StdSequenceProxyRo<Container, StdContiguousAccess<Container>, max_resize, min_resize>(vector)
+  {
+  }
+
+  template <class Container, unsigned max_resize, unsigned min_resize>
+  StdVectorProxy<Container, max_resize, min_resize>::StdVectorProxy()
+    : StdSequenceProxy<Container, StdContiguousAccess<Container>, max_resize, min_resize>()
+  {
+  }
+
+  template <class Container, unsigned max_resize, unsigned min_resize>
+  StdVectorProxy<Container, max_resize, min_resize>::StdVectorProxy(Container &vector)
+    : StdSequenceProxy<Container, StdContiguousAccess<Container>, max_resize, min_resize>(vector)
+  {
+  }
+
+  template <class Container, unsigned max_resize, unsigned min_resize>
+  StdDequeProxyRo<Container, max_resize, min_resize>::StdDequeProxyRo()
+    : StdSequenceProxyRo<Container, StdIteratorAccess<Container>, max_resize, min_resize>()
+  {
+  }
+
+  template <class Container, unsigned max_resize, unsigned min_resize>
+  StdDequeProxyRo<Container, max_resize, min_resize>::StdDequeProxyRo(Container &deque)
+    : StdSequenceProxyRo<Container, StdIteratorAccess<Container>, max_resize, min_resize>(deque)
+  {
+  }
+
+  template <class Container, unsigned max_resize, unsigned min_resize>
+  StdDequeProxy<Container, max_resize, min_resize>::StdDequeProxy()
+    : StdSequenceProxy<Container, StdIteratorAccess<Container>, max_resize, min_resize>()
+  {
+  }
+
+  template <class Container, unsigned max_resize, unsigned min_resize>
+  StdDequeProxy<Container, max_resize, min_resize>::StdDequeProxy(Container &deque)
+    : StdSequenceProxy<Container, StdIteratorAccess<Container>, max_resize, min_resize>(deque)
+  {
+  }
+
+}
+
+#endif
+
@@ -70,6 +70,8 @@ class UserData : public QtLua::Refobj<UserData>
   friend class ValueBase;
   friend class Value;
   friend class ValueRef;
+  friend class QObjectWrapper;
+  friend class Iterator;
   friend uint qHash(const Value &lv);
 
 public:
@@ -128,6 +130,19 @@ public:
    */
   virtual bool meta_contains(State *ls, const Value &key);
 
+  /**
+   * This function performs a table read access only if an entry is
+   * associated to the given key. It returns @tt false if no entry
+   * exists, else the @tt value parameter is updated and @tt true
+   * is returned. This is used by @ref DispatchProxy objects to probe
+   * underlying objects.
+   *
+   * The default implementation relies on the @ref meta_contains and
+   * @ref meta_index functions. It may be reimplemented to perform a
+   * single lookup.
+   */
+  virtual bool meta_try_index(State *ls, const Value &key, Value &value);
+
   /**
    * This function is called when a function invokation operation is
    * performed on a userdata object. The default implementation throws
@@ -140,6 +155,18 @@ public:
    */
   virtual Value::List meta_call(State *ls, const Value::List &args);
 
+  /**
+   * This function is used when the userdata object is called from
+   * lua code. It pushes the returned values on the lua stack. The
+   * default implementation pushes the values returned by the @ref
+   * meta_call function. It may be reimplemented to push values
+   * without creating temporary @ref Value objects.
+   *
+   * @param args List of passed arguments.
+   * @returns number of values pushed on the stack.
+   */
+  virtual int meta_call_push(State *ls, lua_State *st, const Value::List &args);
+
   /**
    * This function may return an @ref Iterator object used to iterate
    * over an userdata object. The default implementation throws an
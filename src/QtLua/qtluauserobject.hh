@@ -76,6 +76,7 @@ namespace QtLua {
       Value get_key() const;
       Value get_value() const;
       ValueRef get_value_ref();
+      int push_next(lua_State *st);
 
       QPointer<State> _ls;
       Ref<UserObject> _obj;
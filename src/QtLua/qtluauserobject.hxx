@@ -159,6 +159,18 @@ namespace QtLua {
 		    Value(_ls, T::_qtlua_properties_table[_index].name));
   }
 
+  template <class T>
+  int UserObject<T>::UserObjectIterator::push_next(lua_State *st)
+  {
+    if (!more())
+      return 0;
+
+    push(st, _ls, T::_qtlua_properties_table[_index].name);
+    push(st, _ls, get_value());
+    _index++;
+    return 2;
+  }
+
 }
 
 #endif
@@ -48,8 +48,12 @@ class Value : public ValueBase
   friend class State;
   friend class UserData;
   friend class TableIterator;
+  friend class Iterator;
   friend class ValueRef;
   friend class ValueBase;
+  friend class QMetaValue;
+  friend class QObjectWrapper;
+  template <class X> friend class PackedValue;
 
 public:
   /** Create a lua value object with no associated @ref State */
@@ -74,6 +78,7 @@ public:
   inline Value(const State *ls, double n);
   inline Value(const State *ls, int n);
   inline Value(const State *ls, unsigned int n);
+  inline Value(const State *ls, long long n);
 
   /** Create a string lua value. @multiple */
   inline Value(const State *ls, const String &str);
@@ -116,6 +121,18 @@ public:
   /** Create a new coroutine value with given entry point lua function. */
   static inline Value new_thread(const State *ls, const Value &main);
 
+#if QT_VERSION >= 0x050000
+  /** Create a lua value from a @ref QJsonValue. JSON arrays and
+      objects are converted to lua tables. @see to_json */
+  static Value from_json(const State *ls, const QJsonValue &json);
+#endif
+
+#if QT_VERSION >= 0x050C00
+  /** Create a lua value from CBOR encoded data. Throw exception if
+      data can not be decoded. @see to_cbor */
+  static Value from_cbor(const State *ls, const QByteArray &cbor);
+#endif
+
   /**
    * Create a lua table indexed from 1 with elements from a @ref QList.
    * @xsee{Qt/Lua types conversion}
@@ -180,6 +197,7 @@ public:
   inline Value & operator=(float n);
   inline Value & operator=(int n);
   inline Value & operator=(unsigned int n);
+  Value & operator=(long long n);
 
   /** Assign a string to lua value. @multiple */
   Value & operator=(const String &str);
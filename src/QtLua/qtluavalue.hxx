@@ -65,14 +65,21 @@ namespace QtLua {
     : ValueBase(ls)
     , _id(_id_counter++)
   {
-    *this = (double)n;
+    *this = (long long)n;
   }
 
   Value::Value(const State *ls, unsigned int n)
     : ValueBase(ls)
     , _id(_id_counter++)
   {
-    *this = (double)n;
+    *this = (long long)n;
+  }
+
+  Value::Value(const State *ls, long long n)
+    : ValueBase(ls)
+    , _id(_id_counter++)
+  {
+    *this = n;
   }
 
   Value::Value(const State *ls, const String &str)
@@ -160,7 +167,7 @@ namespace QtLua {
 
   Value & Value::operator=(int n)
   {
-    *this = (double)n;
+    *this = (long long)n;
     return *this;
   }
 
@@ -172,7 +179,7 @@ namespace QtLua {
 
   Value & Value::operator=(unsigned int n)
   {
-    *this = (double)n;
+    *this = (long long)n;
     return *this;
   }
 
@@ -26,6 +26,9 @@
 #include <QList>
 #include <QPointer>
 #include <QVariant>
+#if QT_VERSION >= 0x050000
+# include <QJsonValue>
+#endif
 
 #include "qtluastring.hh"
 #include "qtluaref.hh"
@@ -41,6 +44,10 @@ class State;
 class UserData;
 class TableIterator;
 class Iterator;
+template <class X> class PackedValue;
+class DispatchProxy;
+template <typename T> struct QHashProxyKeytype;
+template <typename T> struct StdMapProxyKeytype;
 
   /**
    * @short Lua values wrapper base class
@@ -60,6 +67,9 @@ class ValueBase
   friend class Value;
   friend class ValueRef;
   friend uint qHash(const ValueBase &lv);
+  friend class DispatchProxy;
+  template <typename T> friend struct QHashProxyKeytype;
+  template <typename T> friend struct StdMapProxyKeytype;
 
   inline ValueBase(const State *ls);
 
@@ -188,6 +198,17 @@ public:
 
   Q_DECLARE_FLAGS(Operations, Operation);
 
+  /**
+   * Specify how signal emissions are delivered to a connected lua value.
+   * @see connect
+   */
+  enum ConnectMode
+    {
+      ConnectDirect,		//< Call lua value on each signal emission
+      ConnectLatest,		//< Call lua value once per event loop pass with latest signal arguments
+      ConnectBatch,		//< Call lua value once per event loop pass with a table of all arguments tuples
+    };
+
   /**
    * @short List of Value objects used for arguments and return values.
    *
@@ -288,6 +309,7 @@ public:
   /** Convert a lua number value to an integer.
       Throw exception if conversion fails. @multiple */
   inline int to_integer() const;
+  long long to_longlong() const;
   inline operator signed char () const;
   inline operator unsigned char () const;
   inline operator signed short () const;
@@ -436,6 +458,27 @@ public:
    */
   QVariant to_qvariant(int qt_type) const; 
 
+#if QT_VERSION >= 0x050000
+  /**
+   * Convert a lua value to a @ref QJsonValue. Tables with a non zero
+   * length are converted to JSON arrays, other tables are converted
+   * to JSON objects. The table is walked directly on the lua stack.
+   * Throw exception on recursive tables and on values which can not
+   * be represented in JSON.
+   * @see Value::from_json
+   */
+  QJsonValue to_json() const;
+#endif
+
+#if QT_VERSION >= 0x050C00
+  /**
+   * Serialize a lua value in CBOR format. Tables are converted as
+   * with the @ref to_json function.
+   * @see Value::from_cbor
+   */
+  QByteArray to_cbor() const;
+#endif
+
   /** Index operation on a lua userdata or lua table value. @multiple */
   Value at(const Value &key) const;
 
@@ -526,11 +569,18 @@ public:
   /**
    * Connect a @ref QObject signal to a lua value. The value will be
    * called when the signal is emited.
+   *
+   * When the @tt mode parameter is not @ref ConnectDirect, emissions
+   * are coalesced and delivered from the event loop. The @tt max_rate
+   * parameter can then be used to limit the number of calls per
+   * second, zero means no limit.
+   *
    * @see disconnect
    * @see QObject::connect
    * @xsee{QObject wrapping}
    */
-  bool connect(QObject *obj, const char *signal);
+  bool connect(QObject *obj, const char *signal,
+	       ConnectMode mode = ConnectDirect, int max_rate = 0);
 
   /**
    * Disconnect a @ref QObject signal from a lua value.
@@ -554,6 +604,13 @@ protected:
   /** @internal */
   virtual Value value() const = 0;
 
+  /** @internal Get a @ref String object which shares the buffer of
+      a lua string value, no copy of the string content is
+      performed. The returned string must not be used once the lua
+      value has been released. Other value types are converted as
+      with @ref to_string. */
+  String to_string_ref() const;
+
   /** @internal */
   static String to_string_p(lua_State *st, int index, bool quote_string);
 
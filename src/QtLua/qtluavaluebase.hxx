@@ -152,42 +152,42 @@ namespace QtLua {
 
   ValueBase::operator signed char () const
   {
-    return (signed char)to_number();
+    return (signed char)to_longlong();
   }
 
   ValueBase::operator unsigned char () const
   {
-    return (unsigned char)to_number();
+    return (unsigned char)to_longlong();
   }
 
   ValueBase::operator signed short () const
   {
-    return (signed short)to_number();
+    return (signed short)to_longlong();
   }
 
   ValueBase::operator unsigned short () const
   {
-    return (unsigned short)to_number();
+    return (unsigned short)to_longlong();
   }
 
   ValueBase::operator signed int () const
   {
-    return (signed int)to_number();
+    return (signed int)to_longlong();
   }
 
   ValueBase::operator unsigned int () const
   {
-    return (unsigned int)to_number();
+    return (unsigned int)to_longlong();
   }
 
   ValueBase::operator signed long () const
   {
-    return (signed long)to_number();
+    return (signed long)to_longlong();
   }
 
   ValueBase::operator unsigned long () const
   {
-    return (unsigned long)to_number();
+    return (unsigned long)to_longlong();
   }
 
   ValueBase::operator Bool () const
@@ -371,7 +371,7 @@ namespace QtLua {
 
   inline int ValueBase::to_integer() const
   {
-    return (int)to_number();
+    return (int)to_longlong();
   }
 
   template <class X>
@@ -24,6 +24,7 @@
 
 #include <QMetaObject>
 #include <QMetaEnum>
+#include <QHash>
 
 #include <internal/qtluamember.hh>
 
@@ -52,6 +53,9 @@ namespace QtLua {
     bool support(Value::Operation c) const;
     String get_value_str() const;
     void completion_patch(String &path, String &entry, int &offset);
+
+    /** Enum keys to values table */
+    QHash<String, int> _keys;
   };
 
 }
@@ -33,7 +33,8 @@ namespace QtLua {
   class Member;
 
   typedef QMap<String, Ref<Member> > member_cache_t;
-  typedef QHash<const QMetaObject *, MetaCache> meta_cache_t;
+  typedef QHash<String, int> enum_cache_t;
+  typedef QHash<String, Ref<Member> > property_cache_t;
 
 /**
  * @short Cache of existing Qt meta member wrappers
@@ -45,6 +46,10 @@ namespace QtLua {
  * @ref QMetaObject objects. These meta members are exposed to lua
  * through wrapper objects. This class manages a cache of already
  * created @ref Member based wrappers.
+ *
+ * Cache entries are immutable once built and can be looked up from
+ * any thread without locking. A lock is only taken to publish the
+ * entry of a class which has not been seen before.
  */
 
   class MetaCache
@@ -58,9 +63,9 @@ namespace QtLua {
     inline MetaCache(const MetaCache &mc);
 
     /** Get cache meta information for a QObject */
-    inline static MetaCache & get_meta(const QObject &obj);
+    inline static const MetaCache & get_meta(const QObject &obj);
     /** Get cache meta information for a QMetaObject */
-    static MetaCache & get_meta(const QMetaObject *mo);
+    static const MetaCache & get_meta(const QMetaObject *mo);
 
     /** Recursively search for memeber in class and parent classes */
     Ref<Member> get_member(const String &name) const;
@@ -74,16 +79,23 @@ namespace QtLua {
     /** Recursively search for enum value in class and parent classes, return -1 if not found */
     int get_enum_value(const String &name) const;
 
+    /** Get table of enum keys values for class and parent classes */
+    inline const enum_cache_t & get_enum_table() const;
+
     /** Get member table */
     inline const member_cache_t & get_member_table() const;
 
+    /** Get table of property members for class and parent classes */
+    inline const property_cache_t & get_property_table() const;
+
     /** Get associated QMetaObject pointer */
     inline const QMetaObject * get_meta_object() const;
 
   private:
     member_cache_t _member_cache;
+    enum_cache_t _enum_cache;
+    property_cache_t _property_cache;
     const QMetaObject *_mo;
-    static meta_cache_t _meta_cache;
   };
 
 }
@@ -28,6 +28,8 @@ namespace QtLua {
 
   MetaCache::MetaCache(const MetaCache &mc)
     : _member_cache(mc._member_cache),
+      _enum_cache(mc._enum_cache),
+      _property_cache(mc._property_cache),
       _mo(mc._mo)
   {
   }
@@ -37,6 +39,16 @@ namespace QtLua {
     return _member_cache;
   }
 
+  const enum_cache_t & MetaCache::get_enum_table() const
+  {
+    return _enum_cache;
+  }
+
+  const property_cache_t & MetaCache::get_property_table() const
+  {
+    return _property_cache;
+  }
+
   const QMetaObject * MetaCache::get_meta_object() const
   {
     return _mo;
@@ -64,7 +76,7 @@ namespace QtLua {
     return x;
   }
 
-  MetaCache & MetaCache::get_meta(const QObject &obj)
+  const MetaCache & MetaCache::get_meta(const QObject &obj)
   {
     return get_meta(obj.metaObject());
   }
@@ -0,0 +1,115 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008-2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+#ifndef QTLUAPACKEDVALUE_HH_
+#define QTLUAPACKEDVALUE_HH_
+
+#include <QtLua/qtluavalue.hh>
+
+struct lua_State;
+
+namespace QtLua {
+
+/**
+ * @short Compact lua userdata for small Qt value types
+ * @header internal/PackedValue
+ * @module {Base}
+ * @internal
+ *
+ * This internal class is used to expose Qt geometry and color value
+ * types (@ref QPoint, @ref QPointF, @ref QSize, @ref QSizeF, @ref
+ * QRect, @ref QRectF and @ref QColor) to lua. The C++ value is stored
+ * directly in a raw lua userdata block; no @ref UserData object and
+ * no reference counter are involved. All values of the same type
+ * share a single metatable which is stored in the lua registry.
+ *
+ * Fields can be accessed by name or by index, the @tt # operator
+ * returns the number of fields and the @tt pairs function iterates
+ * over fields at integer indexes, as it did on the lua tables used
+ * before packed values were introduced. Arithmetic operators are
+ * available on geometry types.
+ *
+ * C++ code which handles generic lua values uses the @ref
+ * packed_value_type and @ref packed_value_to_table functions to
+ * deal with packed values.
+ */
+
+  template <class X>
+  class PackedValue
+  {
+  public:
+    /** Create a new lua value holding a copy of the C++ value */
+    static Value new_value(State *ls, const X &value);
+
+    /** Push a new packed value holding a copy of the C++ value */
+    static void push_value(lua_State *st, const X &value);
+
+    /** Get C++ value from either a packed value or a lua table of
+	fields stored at consecutive integer indexes. */
+    static void get_value(X &x, const Value &v);
+
+    /** Push a lua table holding the fields of the packed value at
+	given stack index at consecutive integer indexes */
+    static void push_table(lua_State *st, int index);
+
+  private:
+    /** Get pointer to the C++ value of the packed value at given
+	stack index, 0 on type mismatch */
+    static X * to_value(lua_State *st, int index);
+    /** Push shared metatable, create it on first use */
+    static void push_metatable(lua_State *st);
+    /** Get field index from field name or lua index, -1 if not found */
+    static int field_index(lua_State *st, int index);
+
+    static int meta_index(lua_State *st);
+    static int meta_newindex(lua_State *st);
+    static int meta_eq(lua_State *st);
+    static int meta_add(lua_State *st);
+    static int meta_sub(lua_State *st);
+    static int meta_mul(lua_State *st);
+    static int meta_div(lua_State *st);
+    static int meta_unm(lua_State *st);
+    static int meta_len(lua_State *st);
+    static int meta_tostring(lua_State *st);
+    static int meta_pairs(lua_State *st);
+    static int meta_next(lua_State *st);
+
+    /** Registry key of the shared metatable */
+    static char _key;
+  };
+
+  /** @internal Get the Qt meta type handle of the packed value at
+      given stack index, 0 if the value is not a packed value. */
+  int packed_value_type(lua_State *st, int index);
+
+  /** @internal Get the number of fields of the packed value at given
+      stack index, -1 if the value is not a packed value. */
+  int packed_value_len(lua_State *st, int index);
+
+  /** @internal Replace the packed value at given stack index by a
+      lua table holding its fields at consecutive integer indexes.
+      Other values are left untouched. */
+  void packed_value_to_table(lua_State *st, int index);
+
+}
+
+#endif
+
@@ -58,6 +58,12 @@ namespace QtLua {
 
     String get_value_str() const;
     String get_type_name() const;
+
+    /** Meta type id of the property, or 0 when values can not be
+	transferred without going through a @ref QVariant. */
+    int _fast_type;
+    bool _fast_read;
+    bool _fast_write;
   };
 
 }
@@ -22,6 +22,8 @@
 #define QTLUAQMETAOBJECTWRAPPER_HH_
 
 #include <QMetaObject>
+#include <QVector>
+#include <QHash>
 
 #include <QtLua/qtluastate.hh>
 #include <QtLua/qtluauserdata.hh>
@@ -69,8 +71,25 @@ namespace QtLua {
     void completion_patch(String &path, String &entry, int &offset);
     String get_value_str() const;
 
+    /** Resolve parameters types of invokable constructors */
+    void init_constructors() const;
+    /** Find invokable constructor matching lua arguments types */
+    int find_constructor(const Value::List &lua_args) const;
+
+    struct Constructor
+    {
+      int _index;
+      /** parameters meta types */
+      QVector<int> _types;
+    };
+
     const QMetaObject *_mo;
     qobject_creator *_creator;
+    /** invokable constructors, lazily initialized */
+    mutable QVector<Constructor> _ctors;
+    mutable bool _ctors_init;
+    /** lua arguments types signature to constructor index cache */
+    mutable QHash<quint64, int> _ctors_cache;
   };
 
 };
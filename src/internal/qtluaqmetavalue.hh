@@ -24,6 +24,9 @@
 
 #include <QObject>
 #include <QPointer>
+#include <QVector>
+#include <QSet>
+#include <QVariant>
 
 #include <QtLua/qtluametatype.hh>
 #include <QtLua/qtluavalue.hh>
@@ -43,9 +46,69 @@ namespace QtLua {
 
     inline void init(int type);
 
+    /** Push Qt container on lua stack as a table */
+    static void push_container(State *ls, lua_State *st, int type, const void *data, int depth);
+    template <class M>
+    static void push_map(State *ls, lua_State *st, const M &map, int depth);
+    /** Fill Qt container from lua table on stack, return false if
+	not a table. The set holds tables being converted and is used
+	to detect recursive tables. */
+    static bool get_container(int type, void *data, State *ls, lua_State *st, int index,
+			      QSet<const void*> &visited);
+    template <class M>
+    static void get_map(M &map, State *ls, lua_State *st, int index, QSet<const void*> &visited);
+    /** Convert lua value on stack to QVariant, tables are converted recursively */
+    static QVariant get_variant(State *ls, lua_State *st, int index, QSet<const void*> &visited);
+
+    template <int type>
+    static Value container_qt2lua(State *ls, const void *data, metatype_void_t *mt);
+    template <int type>
+    static bool container_lua2qt(void *data, const Value &v, metatype_void_t *mt);
+
+  public:
+    /** @internal Qt to lua conversion function */
+    typedef Value qt2lua_t(State *ls, const void *data, metatype_void_t *mt);
+    /** @internal Lua to Qt conversion function */
+    typedef bool lua2qt_t(void *data, const Value &v, metatype_void_t *mt);
+
+    /** @internal Conversion functions for a Qt meta type, either
+	builtin or relaying to a user @ref MetaType handler. */
+    struct Converter
+    {
+      Converter()
+	: _qt2lua(0), _lua2qt(0), _mt(0)
+      {
+      }
+
+      qt2lua_t *_qt2lua;
+      lua2qt_t *_lua2qt;
+      metatype_void_t *_mt;
+    };
+
+    /** @internal Converters table indexed by Qt meta type handle */
+    static QVector<Converter> & converters();
+    /** @internal Get converter for given type, may return 0 */
+    static inline const Converter * get_converter(int type);
+
+    /** @internal Relay conversion to user @ref MetaType handler */
+    static Value user_qt2lua(State *ls, const void *data, metatype_void_t *mt);
+    /** @internal Relay conversion to user @ref MetaType handler */
+    static bool user_lua2qt(void *data, const Value &v, metatype_void_t *mt);
+
   public:
     static Value raw_get_object(State *ls, int type, const void *data);
     static void raw_set_object(int type, void *data, const Value &v);
+    /** Push value of a Qt object on lua stack, simple types are
+	pushed directly without creating a @ref Value object. */
+    static void raw_push_object(State *ls, lua_State *st, int type, const void *data);
+    /** Check if a lua value of given type is a natural match for a
+	Qt object of given meta type. This check is stricter than
+	actual conversion, numeric strings do not match number types
+	for instance. */
+    static bool check_type(int type, Value::ValueType t);
+    /** Get raw length of the lua table at given stack index, used
+	by bulk container conversions. */
+    static int raw_len(lua_State *st, int index);
 
   public:
 
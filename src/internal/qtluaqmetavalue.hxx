@@ -26,6 +26,16 @@
 
 namespace QtLua {
 
+  const QMetaValue::Converter * QMetaValue::get_converter(int type)
+  {
+    const QVector<Converter> &table = converters();
+
+    if (type < 0 || type >= table.size())
+      return 0;
+
+    return table.constData() + type;
+  }
+
   void QMetaValue::init(int type)
   {
     _type = type;
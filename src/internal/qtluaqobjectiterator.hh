@@ -61,6 +61,7 @@ private:
   Value get_key() const;
   Value get_value() const;
   ValueRef get_value_ref();
+  int push_next(lua_State *st);
 
   enum Current
     {
@@ -71,7 +72,7 @@ private:
 
   QPointer<State> _ls;
   Ref<QObjectWrapper> _qow;
-  MetaCache *_mc;
+  const MetaCache *_mc;
   Current _cur;
   member_cache_t::const_iterator _it;
   int _child_id;
@@ -24,6 +24,10 @@
 
 #include <QObject>
 #include <QMetaObject>
+#include <QVector>
+#include <QHash>
+#include <QQueue>
+#include <QElapsedTimer>
 
 #include <QtLua/qtluauserdata.hh>
 
@@ -39,10 +43,15 @@ namespace QtLua {
  *
  * This internal class implements the @ref QObject wrapper decribed in the
  * @xref{QObject wrapping} section.
+ *
+ * Destruction of wrapped objects is reported by the @ref State
+ * object. A @ref QObject used to receive signals is only allocated
+ * for wrappers which have lua connections.
  */
 
-  class QObjectWrapper : public UserData, public QObject
+  class QObjectWrapper : public UserData
   {
+    friend class State;
     friend class QObjectIterator;
 
   public:
@@ -83,9 +92,17 @@ namespace QtLua {
     /** Find QObject child non-recursively */
     static QObject * get_child(QObject &obj, const String &name);
 
+    /** Read properties whose names are given in a lua array, return
+	a table indexed by property names. */
+    Value get_properties(State *ls, const Value &names);
+
+    /** Assign properties from entries of a lua table indexed by
+	property names. */
+    void set_properties(const Value &table);
+
     // internal use only
-    int qt_metacall(QMetaObject::Call c, int id, void **args);
-    void _lua_connect(int sigindex, const Value &v);
+    void _lua_connect(int sigindex, const Value &v,
+		      ValueBase::ConnectMode mode = ValueBase::ConnectDirect, int max_rate = 0);
     bool _lua_disconnect(int sigindex, const Value &v);
     void _lua_disconnect_all(int sigindex);
     void _lua_disconnect_all();
@@ -111,19 +128,70 @@ namespace QtLua {
 
   private:
 
+    /** Qt object which receives signals connected to lua values */
+    class Receiver : public QObject
+    {
+    public:
+      inline Receiver(QObjectWrapper &qow);
+
+    private:
+      int qt_metacall(QMetaObject::Call c, int id, void **args);
+      void timerEvent(QTimerEvent *event);
+
+      QObjectWrapper &_qow;
+    };
+
+    void lua_slot_call(int slot_id, int sigindex, void **qt_args);
+    void lua_slot_timer(QTimerEvent *event);
+
     struct LuaSlot
     {
-      inline LuaSlot(const Value &v, int sigindex);
+      inline LuaSlot(const Value &v, int sigindex, const QMetaMethod &mm,
+		     ValueBase::ConnectMode mode, int max_rate);
 
       Value _value;
       int _sigindex;
+      /** signal parameters meta types */
+      QVector<int> _types;
+      /** lua value is a plain function which can be called directly */
+      bool _function;
+
+      ValueBase::ConnectMode _mode;
+      /** minimum delay between coalesced calls in ms */
+      int _interval;
+      /** pending delivery timer id, 0 if none */
+      int _timer;
+      /** time of last coalesced call */
+      QElapsedTimer _last;
+      /** pending arguments lists, including sender */
+      QList<Value::List> _pending;
+      /** lua value identity as returned by lua_topointer */
+      const void *_ptr;
     };
 
     typedef QHash<int, LuaSlot> lua_slots_hash_t;
+    typedef QMultiHash<int, int> lua_sig_slots_t;
+    typedef QMultiHash<const void *, int> lua_ptr_slots_t;
+
+    const void * lua_value_ptr(const Value &value);
+    void lua_slot_remove(int slot_id);
+
+    void lua_slot_queue(int slot_id, LuaSlot &slot, const Value::List &lua_args);
+    void lua_slot_cancel(LuaSlot &slot);
+    void lua_slots_clear();
 
     State *_ls;
     QObject *_obj;
+    /** allocated on first lua connection */
+    Receiver *_receiver;
     lua_slots_hash_t _lua_slots;
+    /** signal index to slot ids */
+    lua_sig_slots_t _lua_sig_slots;
+    /** lua value identity to slot ids */
+    lua_ptr_slots_t _lua_ptr_slots;
+    /** released slot ids available for reuse, oldest first */
+    QQueue<int> _lua_free_slots;
+    QHash<int, int> _lua_timers;
     int _lua_next_slot;
     bool _reparent;
     bool _delete;
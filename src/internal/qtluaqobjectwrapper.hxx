@@ -22,6 +22,8 @@
 #ifndef QTLUAQOBJECTWRAPPER_HXX_
 #define QTLUAQOBJECTWRAPPER_HXX_
 
+#include <QMetaMethod>
+
 #include <QtLua/qtluauserdata.hxx>
 
 namespace QtLua {
@@ -54,10 +56,30 @@ namespace QtLua {
     return _ls;
   }
 
-  QObjectWrapper::LuaSlot::LuaSlot(const Value &v, int sigindex)
+  QObjectWrapper::Receiver::Receiver(QObjectWrapper &qow)
+    : _qow(qow)
+  {
+  }
+
+  QObjectWrapper::LuaSlot::LuaSlot(const Value &v, int sigindex, const QMetaMethod &mm,
+				   ValueBase::ConnectMode mode, int max_rate)
     : _value(v),
-      _sigindex(sigindex)
+      _sigindex(sigindex),
+      _function(v.type() == Value::TFunction),
+      _mode(mode),
+      // rates above 1000 calls per second still need a non zero delay
+      _interval(max_rate > 0 ? qMax(1, 1000 / max_rate) : 0),
+      _timer(0),
+      _ptr(0)
   {
+#if QT_VERSION < 0x050000
+    foreach(const QByteArray &pt, mm.parameterTypes())
+      _types.push_back(QMetaType::type(pt.constData()));
+#else
+    _types.reserve(mm.parameterCount());
+    for (int i = 0; i < mm.parameterCount(); i++)
+      _types.push_back(mm.parameterType(i));
+#endif
   }
 
 }
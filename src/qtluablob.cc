@@ -0,0 +1,189 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008-2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+#include <cstring>
+
+#include <QtLua/Blob>
+#include <QtLua/Function>
+#include <QtLua/String>
+
+namespace QtLua {
+
+  /** Translate a lua string index to a 0 based offset, negative
+      index values are relative to the end of the blob. */
+  static inline int blob_offset(int i, int size)
+  {
+    if (i < 0)
+      i += size + 1;
+    return i;
+  }
+
+  /** Get blob range from optional index arguments */
+  static void blob_range(const Value::List &args, int n, int size, int &start, int &end)
+  {
+    start = blob_offset(Function::get_arg<int>(args, n, 1), size);
+    end = blob_offset(Function::get_arg<int>(args, n + 1, -1), size);
+
+    if (start < 1)
+      start = 1;
+    if (end > size)
+      end = size;
+  }
+
+  QTLUA_FUNCTION(blob_sub, "Get a view on a sub range of a blob.",
+		 "usage: blob:sub(i [, j])\n")
+  {
+    Blob::ptr blob = get_arg_ud<Blob>(args, 0);
+    int start, end;
+
+    blob_range(args, 1, blob->size(), start, end);
+
+    if (start > end)
+      return Value(ls, blob->sub(0, 0));
+
+    return Value(ls, blob->sub(start - 1, end - start + 1));
+  }
+
+  QTLUA_FUNCTION(blob_find, "Find a string in a blob.",
+		 "usage: blob:find(str [, init])\n")
+  {
+    Blob::ptr blob = get_arg_ud<Blob>(args, 0);
+    String str = get_arg<String>(args, 1);
+    int init = blob_offset(get_arg<int>(args, 2, 1), blob->size());
+
+    if (init < 1)
+      init = 1;
+
+    // wrap blob content without copy during search
+    QByteArray raw(QByteArray::fromRawData(blob->data(), blob->size()));
+    int i = raw.indexOf(str, init - 1);
+
+    if (i < 0)
+      return Value(ls);
+
+    return Value(ls, i + 1);
+  }
+
+  QTLUA_FUNCTION(blob_tostring, "Copy blob content in a lua string.",
+		 "usage: blob:tostring([i [, j]])\n")
+  {
+    Blob::ptr blob = get_arg_ud<Blob>(args, 0);
+    int start, end;
+
+    blob_range(args, 1, blob->size(), start, end);
+
+    if (start > end)
+      return Value(ls, String(""));
+
+    return Value(ls, String(blob->data() + start - 1, end - start + 1));
+  }
+
+  static QtLua_Function_blob_sub blob_sub;
+  static QtLua_Function_blob_find blob_find;
+  static QtLua_Function_blob_tostring blob_tostring;
+
+  Blob::Blob(const QByteArray &data)
+    : _data(data),
+      _offset(0),
+      _size(data.size())
+  {
+  }
+
+  Blob::Blob(const QByteArray &data, int offset, int size)
+    : _data(data),
+      _offset(offset),
+      _size(size)
+  {
+    if (offset < 0 || size < 0 || offset + size > data.size())
+      QTLUA_THROW(QtLua::Blob, "Blob range is out of byte array bounds.");
+  }
+
+  Blob::ptr Blob::sub(int offset, int size) const
+  {
+    if (offset < 0 || size < 0 || offset + size > _size)
+      QTLUA_THROW(QtLua::Blob, "Blob range is out of bounds.");
+
+    return QTLUA_REFNEW(Blob, _data, _offset + offset, size);
+  }
+
+  Value Blob::meta_index(State *ls, const Value &key)
+  {
+    if (key.type() == Value::TNumber)
+      {
+	int i = key.to_integer();
+
+	if (i < 1 || i > _size)
+	  return Value(ls);
+
+	return Value(ls, (int)(unsigned char)data()[i - 1]);
+      }
+
+    String name(key.to_string());
+
+    if (name == "sub")
+      return Value(ls, blob_sub);
+    if (name == "find")
+      return Value(ls, blob_find);
+    if (name == "tostring")
+      return Value(ls, blob_tostring);
+
+    return Value(ls);
+  }
+
+  Value Blob::meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b)
+  {
+    switch (op)
+      {
+      case Value::OpLen:
+	return Value(ls, _size);
+
+      case Value::OpEq: {
+	Blob::ptr ba = a.to_userdata().dynamiccast<Blob>();
+	Blob::ptr bb = b.to_userdata().dynamiccast<Blob>();
+	return Value(ls, (Value::Bool)(ba.valid() && bb.valid() && ba->_size == bb->_size &&
+				      !memcmp(ba->data(), bb->data(), _size)));
+      }
+
+      default:
+	return UserData::meta_operation(ls, op, a, b);
+      }
+  }
+
+  bool Blob::support(Value::Operation c) const
+  {
+    switch (c)
+      {
+      case Value::OpIndex:
+      case Value::OpLen:
+      case Value::OpEq:
+	return true;
+      default:
+	return false;
+      }
+  }
+
+  String Blob::get_value_str() const
+  {
+    return String("% bytes").arg(_size);
+  }
+
+}
+
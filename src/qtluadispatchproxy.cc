@@ -24,7 +24,11 @@
 
 namespace QtLua {
 
+  /** Maximum number of keys in the route cache */
+  static const int route_cache_max = 1024;
+
   DispatchProxy::DispatchProxy()
+    : _route_cache_enabled(false)
   {
   }
 
@@ -45,18 +49,51 @@ namespace QtLua {
     return UserData::meta_operation(ls, op, a, b);
   }
 
+  void DispatchProxy::enable_route_cache(bool enabled)
+  {
+    _route_cache_enabled = enabled;
+    _route_cache.clear();
+  }
+
   Value DispatchProxy::meta_index(State *ls, const Value &key)
   {
     bool supported = false;
+    bool cache = _route_cache_enabled && key.type() == Value::TString;
+    Value result(ls);
 
-    foreach (const TargetBase *t, _targets)
+    if (cache)
       {
+	QHash<String, int>::iterator i = _route_cache.find(key.to_string_ref());
+
+	if (i != _route_cache.end())
+	  {
+	    if (_targets[*i]->_meta_try_index(ls, key, result))
+	      return result;
+
+	    // entry has been removed from target object
+	    _route_cache.erase(i);
+	  }
+      }
+
+    for (int i = 0; i < _targets.size(); i++)
+      {
+	const TargetBase *t = _targets[i];
+
 	if ((t->_ops & Value::OpIndex) && t->_support(Value::OpIndex))
 	  {
 	    supported = true;
 
-	    if (t->_meta_contains(ls, key))
-	      return t->_meta_index(ls, key);
+	    if (t->_meta_try_index(ls, key, result))
+	      {
+		if (cache)
+		  {
+		    if (_route_cache.size() >= route_cache_max)
+		      _route_cache.clear();
+		    _route_cache.insert(key.to_string(), i);
+		  }
+
+		return result;
+	      }
 	  }
       }
 
@@ -67,6 +104,10 @@ namespace QtLua {
   {
     bool shadow = false;
 
+    // write may add or remove an entry in any target
+    if (_route_cache_enabled && key.type() == Value::TString)
+      _route_cache.remove(key.to_string_ref());
+
     foreach (const TargetBase *t, _targets)
       {
 	if ((t->_ops & Value::OpNewindex) && t->_support(Value::OpNewindex))
@@ -183,5 +224,13 @@ namespace QtLua {
     return _cur->get_value_ref();
   }
 
+  int DispatchProxy::ProxyIterator::push_next(lua_State *st)
+  {
+    if (!more())
+      return 0;
+
+    return _cur->push_next(st);
+  }
+
 }
 
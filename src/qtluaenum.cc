@@ -29,11 +29,30 @@ namespace QtLua {
   Enum::Enum(const QMetaObject *mo, int index)
     : Member(mo, index)
   { 
+    QMetaEnum me = mo->enumerator(index);
+
+    for (int i = 0; i < me.keyCount(); i++)
+      {
+	String key(me.key(i));
+
+	if (!_keys.contains(key))
+	  _keys.insert(key, me.value(i));
+      }
   }
 
   Value Enum::meta_index(State *ls, const Value &key)
   {
-    int value = _mo->enumerator(_index).keyToValue(key.to_string().constData());
+    String name(key.to_string());
+    QHash<String, int>::const_iterator i = _keys.find(name);
+
+    if (i != _keys.end())
+      return i.value() < 0 ? Value(ls) : Value(ls, i.value());
+
+    // Qualified names and flags combinations are not in the table
+    if (!name.contains(':') && !name.contains('|'))
+      return Value(ls);
+
+    int value = _mo->enumerator(_index).keyToValue(name.constData());
     return value < 0 ? Value(ls) : Value(ls, value);
   }
 
@@ -61,5 +61,16 @@ namespace QtLua {
     return ValueRef(Value(), Value());
   }
 
+  int EnumIterator::push_next(lua_State *st)
+  {
+    if (!more())
+      return 0;
+
+    push(st, _ls, _me.key(_index));
+    push(st, _ls, _me.value(_index));
+    _index++;
+    return 2;
+  }
+
 }
 
@@ -0,0 +1,100 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008-2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#include <QtLua/Value>
+#include <QtLua/Iterator>
+#include <QtLua/String>
+
+extern "C" {
+#include <lua.h>
+}
+
+namespace QtLua {
+
+  int Iterator::push_next(lua_State *st)
+  {
+    if (!more())
+      return 0;
+
+    get_key().push_value(st);
+    get_value().push_value(st);
+    next();
+    return 2;
+  }
+
+  void Iterator::push(lua_State *st, const State *ls, int n)
+  {
+    push(st, ls, (long long)n);
+  }
+
+  void Iterator::push(lua_State *st, const State *ls, unsigned int n)
+  {
+    push(st, ls, (long long)n);
+  }
+
+  void Iterator::push(lua_State *st, const State *ls, long long n)
+  {
+#if LUA_VERSION_NUM >= 503
+    lua_pushinteger(st, n);
+#else
+    lua_pushnumber(st, n);
+#endif
+  }
+
+  void Iterator::push(lua_State *st, const State *ls, float n)
+  {
+    lua_pushnumber(st, n);
+  }
+
+  void Iterator::push(lua_State *st, const State *ls, double n)
+  {
+    lua_pushnumber(st, n);
+  }
+
+  void Iterator::push(lua_State *st, const State *ls, const char *str)
+  {
+    lua_pushstring(st, str);
+  }
+
+  void Iterator::push(lua_State *st, const State *ls, const String &str)
+  {
+    lua_pushlstring(st, str.constData(), str.size());
+  }
+
+  void Iterator::push(lua_State *st, const State *ls, const QString &str)
+  {
+    push(st, ls, String(str));
+  }
+
+  void Iterator::push(lua_State *st, const State *ls, const Value &v)
+  {
+    v.push_value(st);
+  }
+
+  void Iterator::push_userdata(lua_State *st, UserData *ud)
+  {
+    if (ud)
+      ud->push_ud(st);
+    else
+      lua_pushnil(st);
+  }
+
+}
+
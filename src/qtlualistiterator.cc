@@ -60,5 +60,16 @@ namespace QtLua {
 		    Value(_ls, (*_it)->get_name()));
   }
 
+  int ListIterator::push_next(lua_State *st)
+  {
+    if (!more())
+      return 0;
+
+    push(st, _ls, (*_it)->get_name());
+    push(st, _ls, *_it);
+    _it++;
+    return 2;
+  }
+
 }
 
@@ -65,7 +65,7 @@ namespace QtLua {
 
     if (_item_id != item_id || _child_row != child_row || _child_col != child_col)
       {
-	Value::List r = _get(Value(ls), Value(ls, (double)item_id),
+	Value::List r = _get(Value(ls), Value(ls, (long long)item_id),
 			     Value(ls, child_row), Value(ls, child_col));
 	_rsize = r.size();
 
@@ -20,6 +20,8 @@
 
 #include <QSet>
 #include <QMetaMethod>
+#include <QMutex>
+#include <QAtomicPointer>
 
 #include <internal/Method>
 #include <internal/Enum>
@@ -28,7 +30,40 @@
 
 namespace QtLua {
 
-  meta_cache_t MetaCache::_meta_cache;
+  /* Lock free hash table of published cache entries. Entries are
+     never removed and new entries are pushed at bucket head. */
+
+  struct meta_cache_entry_s
+  {
+    const QMetaObject *_mo;
+    const MetaCache *_mc;
+    meta_cache_entry_s *_next;
+  };
+
+  enum { META_CACHE_BUCKETS = 256 };
+
+  static QAtomicPointer<meta_cache_entry_s> meta_cache[META_CACHE_BUCKETS];
+  static QMutex meta_cache_lock;
+
+  static inline QAtomicPointer<meta_cache_entry_s> & meta_cache_bucket(const QMetaObject *mo)
+  {
+    return meta_cache[((quintptr)mo >> 4) % META_CACHE_BUCKETS];
+  }
+
+  static inline const MetaCache * meta_cache_lookup(const QMetaObject *mo)
+  {
+#if QT_VERSION < 0x050000
+    meta_cache_entry_s *e = meta_cache_bucket(mo);
+#else
+    meta_cache_entry_s *e = meta_cache_bucket(mo).loadAcquire();
+#endif
+
+    for (; e; e = e->_next)
+      if (e->_mo == mo)
+	return e->_mc;
+
+    return 0;
+  }
 
   MetaCache::MetaCache(const QMetaObject *mo)
     : _mo(mo)
@@ -85,6 +120,25 @@ namespace QtLua {
 	  name += "_e";
 
 	_member_cache.insert(name, QTLUA_REFNEW(Enum, mo, index));
+
+	// Add enum keys to flattened table, first declared key wins
+	for (int j = 0; j < me.keyCount(); j++)
+	  {
+	    String key(me.key(j));
+
+	    if (!_enum_cache.contains(key))
+	      _enum_cache.insert(key, me.value(j));
+	  }
+      }
+
+    // Add enum keys inherited from parent class
+    if (const QMetaObject *super = mo->superClass())
+      {
+	const enum_cache_t &et = get_meta(super).get_enum_table();
+
+	for (enum_cache_t::const_iterator i = et.begin(); i != et.end(); i++)
+	  if (!_enum_cache.contains(i.key()))
+	    _enum_cache.insert(i.key(), i.value());
       }
 
     // Add property members
@@ -101,7 +155,19 @@ namespace QtLua {
 	while (existing.contains(name) || _member_cache.contains(name))
 	  name += "_p";
 
-	_member_cache.insert(name, QTLUA_REFNEW(Property, mo, index));
+	Member::ptr m = QTLUA_REFNEW(Property, mo, index);
+	_member_cache.insert(name, m);
+	_property_cache.insert(name, m);
+      }
+
+    // Add properties inherited from parent class, names do not
+    // collide as members are renamed above
+    if (const QMetaObject *super = mo->superClass())
+      {
+	const property_cache_t &pt = get_meta(super).get_property_table();
+
+	for (property_cache_t::const_iterator i = pt.begin(); i != pt.end(); i++)
+	  _property_cache.insert(i.key(), i.value());
       }
   }
 
@@ -120,6 +186,15 @@ namespace QtLua {
 
   int MetaCache::get_enum_value(const String &name) const
   {
+    enum_cache_t::const_iterator i = _enum_cache.find(name);
+
+    if (i != _enum_cache.end())
+      return i.value();
+
+    // Qualified names and flags combinations are not in the table
+    if (!name.contains(':') && !name.contains('|'))
+      return -1;
+
     for (const QMetaObject *mo = _mo; mo; mo = mo->superClass())
       {
 	for (int i = 0; i < mo->enumeratorCount(); i++)
@@ -139,14 +214,40 @@ namespace QtLua {
     return -1;
   }
 
-  MetaCache & MetaCache::get_meta(const QMetaObject *mo)
+  const MetaCache & MetaCache::get_meta(const QMetaObject *mo)
   {
-    meta_cache_t::iterator i = _meta_cache.find(mo);
+    const MetaCache *mc = meta_cache_lookup(mo);
 
-    if (i != _meta_cache.end())
-      return i.value();
+    if (mc)
+      return *mc;
+
+    // Build entry without holding the lock, parent classes entries
+    // are recursively built by the constructor.
+    MetaCache *nmc = new MetaCache(mo);
+
+    QMutexLocker locker(&meta_cache_lock);
+
+    // Entry may have been published by an other thread meanwhile
+    mc = meta_cache_lookup(mo);
+    if (mc)
+      {
+	delete nmc;
+	return *mc;
+      }
+
+    QAtomicPointer<meta_cache_entry_s> &bucket = meta_cache_bucket(mo);
+    meta_cache_entry_s *e = new meta_cache_entry_s;
+    e->_mo = mo;
+    e->_mc = nmc;
+#if QT_VERSION < 0x050000
+    e->_next = bucket;
+    bucket.fetchAndStoreRelease(e);
+#else
+    e->_next = bucket.loadAcquire();
+    bucket.storeRelease(e);
+#endif
 
-    return _meta_cache.insert(mo, MetaCache(mo)).value();
+    return *nmc;
   }
 
 }
@@ -0,0 +1,520 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008-2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#include <cmath>
+#include <cstring>
+
+#include <QtLua/NumArray>
+#include <QtLua/Function>
+#include <QtLua/String>
+
+namespace QtLua {
+
+  /** Convert a lua number to array element type */
+  template <typename T>
+  static inline T numarray_from_value(const Value &v)
+  {
+    if (numarray_traits<T>::integral)
+      return (T)v.to_longlong();
+    return (T)v.to_number();
+  }
+
+  /*
+   * Element wise operations used by NumArray::map. Loops are
+   * instantiated for each operation so that the compiler is able to
+   * vectorize them.
+   */
+
+  struct numarray_abs
+  {
+    template <typename T>
+    static inline T f(T x) { return x < 0 ? -x : x; }
+  };
+
+  struct numarray_neg
+  {
+    template <typename T>
+    static inline T f(T x) { return -x; }
+  };
+
+  struct numarray_square
+  {
+    template <typename T>
+    static inline T f(T x) { return x * x; }
+  };
+
+#define QTLUA_NUMARRAY_REAL_OP(name, func)				\
+  struct numarray_##name						\
+  {									\
+    template <typename T>						\
+    static inline T f(T x)						\
+    {									\
+      return (T)func((typename numarray_traits<T>::real)x);		\
+    }									\
+  };
+
+  QTLUA_NUMARRAY_REAL_OP(sqrt, std::sqrt)
+  QTLUA_NUMARRAY_REAL_OP(exp, std::exp)
+  QTLUA_NUMARRAY_REAL_OP(log, std::log)
+  QTLUA_NUMARRAY_REAL_OP(sin, std::sin)
+  QTLUA_NUMARRAY_REAL_OP(cos, std::cos)
+  QTLUA_NUMARRAY_REAL_OP(floor, std::floor)
+  QTLUA_NUMARRAY_REAL_OP(ceil, std::ceil)
+
+  template <class Op, typename T>
+  static void numarray_map(T *p, int n)
+  {
+    for (int i = 0; i < n; i++)
+      p[i] = Op::f(p[i]);
+  }
+
+  static const char * const numarray_map_names[] = {
+    "abs", "neg", "square", "sqrt", "exp",
+    "log", "sin", "cos", "floor", "ceil", 0
+  };
+
+  /** Translate a lua index to a 1 based index, negative index values
+      are relative to the end of the array. */
+  static inline int numarray_index(int i, int size)
+  {
+    if (i < 0)
+      i += size + 1;
+    return i;
+  }
+
+  /*
+   * Lua methods
+   */
+
+  template <typename T>
+  class NumArray<T>::Method : public Function
+  {
+  public:
+    enum Id
+      {
+	Sum, Min, Max, Scale, Axpy, Dot, Map, Slice, CopyFrom
+      };
+
+    Method(Id id)
+      : _id(id)
+    {
+    }
+
+    /** Get method object from method name, null if not found */
+    static Method * get(const String &name);
+
+  private:
+    Value::List meta_call(State *ls, const Value::List &args);
+    String get_description() const;
+    String get_help() const;
+
+    Id _id;
+  };
+
+  static const char * const numarray_method_names[] = {
+    "sum", "min", "max", "scale", "axpy", "dot", "map", "slice", "copy_from", 0
+  };
+
+  static const char * const numarray_method_help[] = {
+    "usage: array:sum()\n",
+    "usage: array:min()\n",
+    "usage: array:max()\n",
+    "usage: array:scale(k)\n",
+    "usage: array:axpy(a, x_array)\n",
+    "usage: array:dot(x_array)\n",
+    "usage: array:map(\"abs\"|\"neg\"|\"square\"|\"sqrt\"|\"exp\"|\"log\"|\"sin\"|\"cos\"|\"floor\"|\"ceil\")\n",
+    "usage: array:slice(i [, j])\n",
+    "usage: array:copy_from(src_array [, i])\n",
+  };
+
+  template <typename T>
+  typename NumArray<T>::Method * NumArray<T>::Method::get(const String &name)
+  {
+    static Method methods[] = {
+      Method(Sum), Method(Min), Method(Max), Method(Scale), Method(Axpy),
+      Method(Dot), Method(Map), Method(Slice), Method(CopyFrom)
+    };
+
+    for (int i = 0; numarray_method_names[i]; i++)
+      if (!qstrcmp(name.constData(), numarray_method_names[i]))
+	return methods + i;
+
+    return 0;
+  }
+
+  template <typename T>
+  String NumArray<T>::Method::get_description() const
+  {
+    return String("NumArray method.");
+  }
+
+  template <typename T>
+  String NumArray<T>::Method::get_help() const
+  {
+    return String(numarray_method_help[_id]);
+  }
+
+  template <typename T>
+  Value::List NumArray<T>::Method::meta_call(State *ls, const Value::List &args)
+  {
+    typename NumArray<T>::ptr a = get_arg_ud<NumArray<T> >(args, 0);
+
+    switch (_id)
+      {
+      case Sum:
+	return Value(ls, a->sum());
+
+      case Min:
+	return Value(ls, a->min());
+
+      case Max:
+	return Value(ls, a->max());
+
+      case Scale:
+	a->scale(numarray_from_value<T>(get_arg<const Value &>(args, 1)));
+	return Value::List();
+
+      case Axpy:
+	a->axpy(numarray_from_value<T>(get_arg<const Value &>(args, 1)),
+		*get_arg_ud<NumArray<T> >(args, 2));
+	return Value::List();
+
+      case Dot:
+	return Value(ls, a->dot(*get_arg_ud<NumArray<T> >(args, 1)));
+
+      case Map: {
+	String op = get_arg<String>(args, 1);
+
+	for (int i = 0; numarray_map_names[i]; i++)
+	  if (!qstrcmp(op.constData(), numarray_map_names[i]))
+	    {
+	      a->map((MapOp)i);
+	      return Value::List();
+	    }
+
+	QTLUA_THROW(QtLua::NumArray, "Unknown map operation `%'.", .arg(op));
+      }
+
+      case Slice: {
+	int size = a->size();
+	int start = numarray_index(get_arg<int>(args, 1, 1), size);
+	int end = numarray_index(get_arg<int>(args, 2, -1), size);
+
+	if (start < 1)
+	  start = 1;
+	if (end > size)
+	  end = size;
+	if (start > end)
+	  return Value(ls, a->slice(0, 0));
+
+	return Value(ls, a->slice(start - 1, end - start + 1));
+      }
+
+      case CopyFrom:
+	a->copy_from(*get_arg_ud<NumArray<T> >(args, 1),
+		     numarray_index(get_arg<int>(args, 2, 1), a->size()) - 1);
+	return Value::List();
+      }
+
+    return Value::List();
+  }
+
+  /*
+   * NumArray
+   */
+
+  template <typename T>
+  NumArray<T>::NumArray(int size)
+    : _data(size, T())
+  {
+  }
+
+  template <typename T>
+  NumArray<T>::NumArray(const QVector<T> &vector)
+    : _data(vector)
+  {
+  }
+
+  template <typename T>
+  typename NumArray<T>::ptr NumArray<T>::from_value(const Value &init)
+  {
+    if (init.type() == Value::TNumber)
+      {
+	int size = init.to_integer();
+
+	if (size < 0)
+	  QTLUA_THROW(QtLua::NumArray, "Bad negative array size `%'.", .arg(size));
+
+	return QTLUA_REFNEW(NumArray, size);
+      }
+
+    int size = init.len();
+    ptr a = QTLUA_REFNEW(NumArray, size);
+    T *p = a->data();
+
+    for (int i = 0; i < size; i++)
+      p[i] = numarray_from_value<T>(init.at(i + 1));
+
+    return a;
+  }
+
+  template <typename T>
+  typename NumArray<T>::accum_type NumArray<T>::sum() const
+  {
+    typedef accum_type A;
+    const T *p = data();
+    int n = size();
+    int i = 0;
+
+    // independent partial sums let the compiler use vector registers
+    A s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (; i + 4 <= n; i += 4)
+      {
+	s0 += p[i];
+	s1 += p[i + 1];
+	s2 += p[i + 2];
+	s3 += p[i + 3];
+      }
+    for (; i < n; i++)
+      s0 += p[i];
+
+    return (s0 + s1) + (s2 + s3);
+  }
+
+  template <typename T>
+  T NumArray<T>::min() const
+  {
+    const T *p = data();
+    int n = size();
+
+    if (!n)
+      QTLUA_THROW(QtLua::NumArray, "Can not get the smallest element of an empty array.");
+
+    T m = p[0];
+    for (int i = 1; i < n; i++)
+      m = p[i] < m ? p[i] : m;
+
+    return m;
+  }
+
+  template <typename T>
+  T NumArray<T>::max() const
+  {
+    const T *p = data();
+    int n = size();
+
+    if (!n)
+      QTLUA_THROW(QtLua::NumArray, "Can not get the largest element of an empty array.");
+
+    T m = p[0];
+    for (int i = 1; i < n; i++)
+      m = p[i] > m ? p[i] : m;
+
+    return m;
+  }
+
+  template <typename T>
+  void NumArray<T>::scale(T k)
+  {
+    T *p = data();
+    int n = size();
+
+    for (int i = 0; i < n; i++)
+      p[i] *= k;
+  }
+
+  template <typename T>
+  void NumArray<T>::axpy(T a, const NumArray &x)
+  {
+    if (x.size() != size())
+      QTLUA_THROW(QtLua::NumArray, "Array size mismatch, % and % elements.",
+		  .arg(size()).arg(x.size()));
+
+    // keep a reference on source storage in case both arrays share it
+    QVector<T> xv(x._data);
+    const T *q = xv.constData();
+    T *p = data();
+    int n = size();
+
+    for (int i = 0; i < n; i++)
+      p[i] += a * q[i];
+  }
+
+  template <typename T>
+  typename NumArray<T>::accum_type NumArray<T>::dot(const NumArray &x) const
+  {
+    if (x.size() != size())
+      QTLUA_THROW(QtLua::NumArray, "Array size mismatch, % and % elements.",
+		  .arg(size()).arg(x.size()));
+
+    typedef accum_type A;
+    const T *p = data();
+    const T *q = x.data();
+    int n = size();
+    int i = 0;
+
+    A s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (; i + 4 <= n; i += 4)
+      {
+	s0 += (A)p[i] * q[i];
+	s1 += (A)p[i + 1] * q[i + 1];
+	s2 += (A)p[i + 2] * q[i + 2];
+	s3 += (A)p[i + 3] * q[i + 3];
+      }
+    for (; i < n; i++)
+      s0 += (A)p[i] * q[i];
+
+    return (s0 + s1) + (s2 + s3);
+  }
+
+  template <typename T>
+  void NumArray<T>::map(MapOp op)
+  {
+    T *p = data();
+    int n = size();
+
+    switch (op)
+      {
+      case MapAbs:
+	return numarray_map<numarray_abs>(p, n);
+      case MapNeg:
+	return numarray_map<numarray_neg>(p, n);
+      case MapSquare:
+	return numarray_map<numarray_square>(p, n);
+      case MapSqrt:
+	return numarray_map<numarray_sqrt>(p, n);
+      case MapExp:
+	return numarray_map<numarray_exp>(p, n);
+      case MapLog:
+	return numarray_map<numarray_log>(p, n);
+      case MapSin:
+	return numarray_map<numarray_sin>(p, n);
+      case MapCos:
+	return numarray_map<numarray_cos>(p, n);
+      case MapFloor:
+	if (!numarray_traits<T>::integral)
+	  numarray_map<numarray_floor>(p, n);
+	return;
+      case MapCeil:
+	if (!numarray_traits<T>::integral)
+	  numarray_map<numarray_ceil>(p, n);
+	return;
+      }
+  }
+
+  template <typename T>
+  typename NumArray<T>::ptr NumArray<T>::slice(int offset, int size) const
+  {
+    if (offset < 0 || size < 0 || offset + size > _data.size())
+      QTLUA_THROW(QtLua::NumArray, "Array range is out of bounds.");
+
+    if (offset == 0 && size == _data.size())
+      return QTLUA_REFNEW(NumArray, _data);
+
+    return QTLUA_REFNEW(NumArray, _data.mid(offset, size));
+  }
+
+  template <typename T>
+  void NumArray<T>::copy_from(const NumArray &src, int offset)
+  {
+    if (offset < 0 || offset + src.size() > size())
+      QTLUA_THROW(QtLua::NumArray, "Array range is out of bounds.");
+
+    QVector<T> sv(src._data);
+    std::memmove(data() + offset, sv.constData(), sv.size() * sizeof(T));
+  }
+
+  template <typename T>
+  Value NumArray<T>::meta_index(State *ls, const Value &key)
+  {
+    if (key.type() == Value::TNumber)
+      {
+	int i = key.to_integer();
+
+	if (i < 1 || i > _data.size())
+	  return Value(ls);
+
+	return Value(ls, _data.at(i - 1));
+      }
+
+    if (Method *m = Method::get(key.to_string()))
+      return Value(ls, m);
+
+    return Value(ls);
+  }
+
+  template <typename T>
+  void NumArray<T>::meta_newindex(State *ls, const Value &key, const Value &value)
+  {
+    int i = key.to_integer();
+
+    if (i < 1 || i > _data.size())
+      QTLUA_THROW(QtLua::NumArray, "Index `%' is out of array bounds.", .arg(i));
+
+    _data[i - 1] = numarray_from_value<T>(value);
+  }
+
+  template <typename T>
+  Value NumArray<T>::meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b)
+  {
+    switch (op)
+      {
+      case Value::OpLen:
+	return Value(ls, _data.size());
+
+      case Value::OpEq: {
+	ptr aa = a.to_userdata().dynamiccast<NumArray>();
+	ptr ab = b.to_userdata().dynamiccast<NumArray>();
+	return Value(ls, (Value::Bool)(aa.valid() && ab.valid() && aa->_data == ab->_data));
+      }
+
+      default:
+	return UserData::meta_operation(ls, op, a, b);
+      }
+  }
+
+  template <typename T>
+  bool NumArray<T>::support(Value::Operation c) const
+  {
+    switch (c)
+      {
+      case Value::OpIndex:
+      case Value::OpNewindex:
+      case Value::OpLen:
+      case Value::OpEq:
+	return true;
+      default:
+	return false;
+      }
+  }
+
+  template <typename T>
+  String NumArray<T>::get_value_str() const
+  {
+    return String("% % elements").arg(_data.size()).arg(numarray_traits<T>::name());
+  }
+
+  template class NumArray<float>;
+  template class NumArray<double>;
+  template class NumArray<qint32>;
+  template class NumArray<qint64>;
+
+}
+
@@ -0,0 +1,644 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008-2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+#include <new>
+
+#include <QPoint>
+#include <QPointF>
+#include <QSize>
+#include <QSizeF>
+#include <QRect>
+#include <QRectF>
+#include <QColor>
+
+#include <QtLua/String>
+#include <QtLua/State>
+#include <internal/PackedValue>
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+namespace QtLua {
+
+  /** Fields access and properties of packed value types */
+  template <class X>
+  struct packed_traits;
+
+#define QTLUA_PACKED_TRAITS(X, arith_, count_, table_count_, ...)	\
+  template <>								\
+  struct packed_traits<X>						\
+  {									\
+    enum {								\
+      /* number of fields */						\
+      count = count_,							\
+      /* number of fields read from a lua table */			\
+      table_count = table_count_,					\
+      /* support arithmetic operators */				\
+      arith = arith_							\
+    };									\
+									\
+    static const char * type_name()					\
+    {									\
+      return #X;							\
+    }									\
+									\
+    static const char * name(int i)					\
+    {									\
+      static const char * const names[] = { __VA_ARGS__ };		\
+      return names[i];							\
+    }									\
+									\
+    static inline double get(const X &x, int i);			\
+    static inline void set(X &x, int i, double v);			\
+  };
+
+  QTLUA_PACKED_TRAITS(QPoint, 1, 2, 2, "x", "y")
+  QTLUA_PACKED_TRAITS(QPointF, 1, 2, 2, "x", "y")
+  QTLUA_PACKED_TRAITS(QSize, 1, 2, 2, "width", "height")
+  QTLUA_PACKED_TRAITS(QSizeF, 1, 2, 2, "width", "height")
+  QTLUA_PACKED_TRAITS(QRect, 1, 4, 4, "x", "y", "width", "height")
+  QTLUA_PACKED_TRAITS(QRectF, 1, 4, 4, "x", "y", "width", "height")
+  QTLUA_PACKED_TRAITS(QColor, 0, 4, 3, "red", "green", "blue", "alpha")
+
+  template <class X>
+  static inline double point_get(const X &p, int i)
+  {
+    return i ? p.y() : p.x();
+  }
+
+  template <class X>
+  static inline void point_set(X &p, int i, double v)
+  {
+    if (i)
+      p.setY(v);
+    else
+      p.setX(v);
+  }
+
+  template <class X>
+  static inline double size_get(const X &s, int i)
+  {
+    return i ? s.height() : s.width();
+  }
+
+  template <class X>
+  static inline void size_set(X &s, int i, double v)
+  {
+    if (i)
+      s.setHeight(v);
+    else
+      s.setWidth(v);
+  }
+
+  template <class X>
+  static inline double rect_get(const X &r, int i)
+  {
+    switch (i)
+      {
+      case 0:
+	return r.x();
+      case 1:
+	return r.y();
+      case 2:
+	return r.width();
+      default:
+	return r.height();
+      }
+  }
+
+  template <class X>
+  static inline void rect_set(X &r, int i, double v)
+  {
+    // keep size when moving origin
+    switch (i)
+      {
+      case 0:
+	r.moveLeft(v);
+	break;
+      case 1:
+	r.moveTop(v);
+	break;
+      case 2:
+	r.setWidth(v);
+	break;
+      default:
+	r.setHeight(v);
+	break;
+      }
+  }
+
+  static inline double color_get(const QColor &c, int i)
+  {
+    switch (i)
+      {
+      case 0:
+	return c.red();
+      case 1:
+	return c.green();
+      case 2:
+	return c.blue();
+      default:
+	return c.alpha();
+      }
+  }
+
+  static inline void color_set(QColor &c, int i, double v)
+  {
+    switch (i)
+      {
+      case 0:
+	c.setRed(v);
+	break;
+      case 1:
+	c.setGreen(v);
+	break;
+      case 2:
+	c.setBlue(v);
+	break;
+      default:
+	c.setAlpha(v);
+	break;
+      }
+  }
+
+#define QTLUA_PACKED_ACCESSORS(X, prefix)				\
+  double packed_traits<X>::get(const X &x, int i)			\
+  {									\
+    return prefix##_get(x, i);						\
+  }									\
+									\
+  void packed_traits<X>::set(X &x, int i, double v)			\
+  {									\
+    prefix##_set(x, i, v);						\
+  }
+
+  QTLUA_PACKED_ACCESSORS(QPoint, point)
+  QTLUA_PACKED_ACCESSORS(QPointF, point)
+  QTLUA_PACKED_ACCESSORS(QSize, size)
+  QTLUA_PACKED_ACCESSORS(QSizeF, size)
+  QTLUA_PACKED_ACCESSORS(QRect, rect)
+  QTLUA_PACKED_ACCESSORS(QRectF, rect)
+  QTLUA_PACKED_ACCESSORS(QColor, color)
+
+  template <class X>
+  char PackedValue<X>::_key;
+
+  /** Key of the meta type handle stored in packed values metatables */
+  static char packed_type_key;
+
+  template <class X>
+  void PackedValue<X>::push_metatable(lua_State *st)
+  {
+    lua_pushlightuserdata(st, &_key);
+    lua_rawget(st, LUA_REGISTRYINDEX);
+
+    if (!lua_isnil(st, -1))
+      return;
+
+    lua_pop(st, 1);
+    lua_newtable(st);
+
+#define QTLUA_PACKED_META_BIND(n)		\
+    lua_pushstring(st, "__" #n);		\
+    lua_pushcfunction(st, meta_##n);		\
+    lua_rawset(st, -3);
+
+    QTLUA_PACKED_META_BIND(index);
+    QTLUA_PACKED_META_BIND(newindex);
+    QTLUA_PACKED_META_BIND(eq);
+    QTLUA_PACKED_META_BIND(len);
+    QTLUA_PACKED_META_BIND(tostring);
+    QTLUA_PACKED_META_BIND(pairs);
+
+    if (packed_traits<X>::arith)
+      {
+	QTLUA_PACKED_META_BIND(add);
+	QTLUA_PACKED_META_BIND(sub);
+	QTLUA_PACKED_META_BIND(mul);
+	QTLUA_PACKED_META_BIND(div);
+	QTLUA_PACKED_META_BIND(unm);
+      }
+
+#undef QTLUA_PACKED_META_BIND
+
+    // used by lua 5.3 error messages and ValueBase::type_name_u
+    lua_pushstring(st, "__name");
+    lua_pushstring(st, packed_traits<X>::type_name());
+    lua_rawset(st, -3);
+
+    lua_pushlightuserdata(st, &packed_type_key);
+    lua_pushnumber(st, qMetaTypeId<X>());
+    lua_rawset(st, -3);
+
+    lua_pushlightuserdata(st, &_key);
+    lua_pushvalue(st, -2);
+    lua_rawset(st, LUA_REGISTRYINDEX);
+  }
+
+  template <class X>
+  void PackedValue<X>::push_value(lua_State *st, const X &value)
+  {
+    // stored types have trivial destructors, no __gc is needed
+    new (lua_newuserdata(st, sizeof(X))) X(value);
+    push_metatable(st);
+    lua_setmetatable(st, -2);
+  }
+
+  template <class X>
+  Value PackedValue<X>::new_value(State *ls, const X &value)
+  {
+    lua_State *st = ls->get_lua_state();
+
+    if (!lua_checkstack(st, 3))
+      QTLUA_THROW(QtLua::PackedValue, "Unable to extend the lua stack.");
+
+    push_value(st, value);
+    Value res(-1, ls);
+    lua_pop(st, 1);
+    return res;
+  }
+
+  template <class X>
+  X * PackedValue<X>::to_value(lua_State *st, int index)
+  {
+    if (lua_type(st, index) != LUA_TUSERDATA || !lua_getmetatable(st, index))
+      return 0;
+
+    lua_pushlightuserdata(st, &_key);
+    lua_rawget(st, LUA_REGISTRYINDEX);
+    bool same = lua_rawequal(st, -1, -2);
+    lua_pop(st, 2);
+
+    return same ? static_cast<X*>(lua_touserdata(st, index)) : 0;
+  }
+
+  template <class X>
+  void PackedValue<X>::get_value(X &x, const Value &v)
+  {
+    if (v.type() == Value::TUserData)
+      {
+	lua_State *st = v.get_state()->get_lua_state();
+
+	v.push_value(st);
+	X *p = to_value(st, -1);
+	if (p)
+	  x = *p;
+	lua_pop(st, 1);
+
+	if (p)
+	  return;
+      }
+
+    // table with fields at integer indexes
+    for (int i = 0; i < packed_traits<X>::table_count; i++)
+      packed_traits<X>::set(x, i, v.at(i + 1).to_number());
+  }
+
+  template <class X>
+  void PackedValue<X>::push_table(lua_State *st, int index)
+  {
+    X *x = to_value(st, index);
+
+#if LUA_VERSION_NUM < 501
+    lua_newtable(st);
+#else
+    lua_createtable(st, packed_traits<X>::count, 0);
+#endif
+
+    if (!x)
+      return;
+
+    for (int i = 0; i < packed_traits<X>::count; i++)
+      {
+	lua_pushnumber(st, packed_traits<X>::get(*x, i));
+	lua_rawseti(st, -2, i + 1);
+      }
+  }
+
+  template <class X>
+  int PackedValue<X>::field_index(lua_State *st, int index)
+  {
+    switch (lua_type(st, index))
+      {
+      case LUA_TNUMBER: {
+	lua_Number n = lua_tonumber(st, index);
+	return n >= 1 && n <= packed_traits<X>::count ? (int)n - 1 : -1;
+      }
+
+      case LUA_TSTRING: {
+	const char *name = lua_tostring(st, index);
+	for (int i = 0; i < packed_traits<X>::count; i++)
+	  if (!qstrcmp(name, packed_traits<X>::name(i)))
+	    return i;
+	return -1;
+      }
+
+      default:
+	return -1;
+      }
+  }
+
+  template <class X>
+  int PackedValue<X>::meta_index(lua_State *st)
+  {
+    X *x = to_value(st, 1);
+    int i = field_index(st, 2);
+
+    if (!x || i < 0)
+      lua_pushnil(st);
+    else
+      lua_pushnumber(st, packed_traits<X>::get(*x, i));
+    return 1;
+  }
+
+  template <class X>
+  int PackedValue<X>::meta_newindex(lua_State *st)
+  {
+    X *x = to_value(st, 1);
+    int i = field_index(st, 2);
+
+    if (!x || i < 0)
+      return luaL_error(st, "No `%s' field in `%s' value.",
+			lua_type(st, 2) == LUA_TSTRING ? lua_tostring(st, 2)
+			: lua_typename(st, lua_type(st, 2)),
+			packed_traits<X>::type_name());
+
+    packed_traits<X>::set(*x, i, luaL_checknumber(st, 3));
+    return 0;
+  }
+
+  template <class X>
+  int PackedValue<X>::meta_eq(lua_State *st)
+  {
+    X *a = to_value(st, 1);
+    X *b = to_value(st, 2);
+
+    lua_pushboolean(st, a && b && *a == *b);
+    return 1;
+  }
+
+  template <class X>
+  int PackedValue<X>::meta_add(lua_State *st)
+  {
+    X *a = to_value(st, 1);
+    X *b = to_value(st, 2);
+
+    if (!a || !b)
+      return luaL_error(st, "Bad operands for the `+' operation on a `%s' value.",
+			packed_traits<X>::type_name());
+
+    X r(*a);
+    for (int i = 0; i < packed_traits<X>::count; i++)
+      packed_traits<X>::set(r, i, packed_traits<X>::get(r, i) + packed_traits<X>::get(*b, i));
+    push_value(st, r);
+    return 1;
+  }
+
+  template <class X>
+  int PackedValue<X>::meta_sub(lua_State *st)
+  {
+    X *a = to_value(st, 1);
+    X *b = to_value(st, 2);
+
+    if (!a || !b)
+      return luaL_error(st, "Bad operands for the `-' operation on a `%s' value.",
+			packed_traits<X>::type_name());
+
+    X r(*a);
+    for (int i = 0; i < packed_traits<X>::count; i++)
+      packed_traits<X>::set(r, i, packed_traits<X>::get(r, i) - packed_traits<X>::get(*b, i));
+    push_value(st, r);
+    return 1;
+  }
+
+  template <class X>
+  int PackedValue<X>::meta_mul(lua_State *st)
+  {
+    // scale by a number on either side
+    X *a = to_value(st, 1);
+    X *b = to_value(st, 2);
+    X r;
+    lua_Number f;
+
+    if (a && lua_type(st, 2) == LUA_TNUMBER)
+      {
+	r = *a;
+	f = lua_tonumber(st, 2);
+      }
+    else if (b && lua_type(st, 1) == LUA_TNUMBER)
+      {
+	r = *b;
+	f = lua_tonumber(st, 1);
+      }
+    else
+      return luaL_error(st, "Bad operands for the `*' operation on a `%s' value.",
+			packed_traits<X>::type_name());
+
+    for (int i = 0; i < packed_traits<X>::count; i++)
+      packed_traits<X>::set(r, i, packed_traits<X>::get(r, i) * f);
+    push_value(st, r);
+    return 1;
+  }
+
+  template <class X>
+  int PackedValue<X>::meta_div(lua_State *st)
+  {
+    // division by a number on right side only
+    X *a = to_value(st, 1);
+
+    if (!a || lua_type(st, 2) != LUA_TNUMBER)
+      return luaL_error(st, "Bad operands for the `/' operation on a `%s' value.",
+			packed_traits<X>::type_name());
+
+    X r(*a);
+    lua_Number f = lua_tonumber(st, 2);
+    for (int i = 0; i < packed_traits<X>::count; i++)
+      packed_traits<X>::set(r, i, packed_traits<X>::get(r, i) / f);
+    push_value(st, r);
+    return 1;
+  }
+
+  template <class X>
+  int PackedValue<X>::meta_unm(lua_State *st)
+  {
+    X *a = to_value(st, 1);
+
+    if (!a)
+      return luaL_error(st, "Bad operand for the unary `-' operation on a `%s' value.",
+			packed_traits<X>::type_name());
+
+    X r(*a);
+    for (int i = 0; i < packed_traits<X>::count; i++)
+      packed_traits<X>::set(r, i, -packed_traits<X>::get(r, i));
+    push_value(st, r);
+    return 1;
+  }
+
+  template <class X>
+  int PackedValue<X>::meta_len(lua_State *st)
+  {
+    lua_pushnumber(st, packed_traits<X>::count);
+    return 1;
+  }
+
+  template <class X>
+  int PackedValue<X>::meta_tostring(lua_State *st)
+  {
+    X *x = to_value(st, 1);
+
+    if (!x)
+      return 0;
+
+    QByteArray s(packed_traits<X>::type_name());
+
+    s += "(";
+    for (int i = 0; i < packed_traits<X>::count; i++)
+      {
+	if (i)
+	  s += ", ";
+	s += QByteArray::number(packed_traits<X>::get(*x, i));
+      }
+    s += ")";
+
+    lua_pushlstring(st, s.constData(), s.size());
+    return 1;
+  }
+
+  template <class X>
+  int PackedValue<X>::meta_pairs(lua_State *st)
+  {
+    lua_pushcfunction(st, meta_next);
+    lua_pushvalue(st, 1);
+    lua_pushnil(st);
+    return 3;
+  }
+
+  template <class X>
+  int PackedValue<X>::meta_next(lua_State *st)
+  {
+    // iterate over integer indexes like on the equivalent table
+    X *x = to_value(st, 1);
+    int i = 0;
+
+    if (!lua_isnil(st, 2))
+      {
+	i = field_index(st, 2);
+	// ends on bad key
+	if (i < 0)
+	  return 0;
+	i++;
+      }
+
+    if (!x || i >= packed_traits<X>::count)
+      return 0;
+
+    lua_pushnumber(st, i + 1);
+    lua_pushnumber(st, packed_traits<X>::get(*x, i));
+    return 2;
+  }
+
+  template class PackedValue<QPoint>;
+  template class PackedValue<QPointF>;
+  template class PackedValue<QSize>;
+  template class PackedValue<QSizeF>;
+  template class PackedValue<QRect>;
+  template class PackedValue<QRectF>;
+  template class PackedValue<QColor>;
+
+  int packed_value_type(lua_State *st, int index)
+  {
+    if (lua_type(st, index) != LUA_TUSERDATA || !lua_getmetatable(st, index))
+      return 0;
+
+    lua_pushlightuserdata(st, &packed_type_key);
+    lua_rawget(st, -2);
+    int type = lua_type(st, -1) == LUA_TNUMBER ? (int)lua_tonumber(st, -1) : 0;
+    lua_pop(st, 2);
+
+    return type;
+  }
+
+  int packed_value_len(lua_State *st, int index)
+  {
+    switch (packed_value_type(st, index))
+      {
+      case QMetaType::QPoint:
+	return packed_traits<QPoint>::count;
+      case QMetaType::QPointF:
+	return packed_traits<QPointF>::count;
+      case QMetaType::QSize:
+	return packed_traits<QSize>::count;
+      case QMetaType::QSizeF:
+	return packed_traits<QSizeF>::count;
+      case QMetaType::QRect:
+	return packed_traits<QRect>::count;
+      case QMetaType::QRectF:
+	return packed_traits<QRectF>::count;
+      case QMetaType::QColor:
+	return packed_traits<QColor>::count;
+      default:
+	return -1;
+      }
+  }
+
+  void packed_value_to_table(lua_State *st, int index)
+  {
+    int type = packed_value_type(st, index);
+
+    if (!type)
+      return;
+
+    if (index < 0)
+      index += lua_gettop(st) + 1;
+
+    switch (type)
+      {
+      case QMetaType::QPoint:
+	PackedValue<QPoint>::push_table(st, index);
+	break;
+      case QMetaType::QPointF:
+	PackedValue<QPointF>::push_table(st, index);
+	break;
+      case QMetaType::QSize:
+	PackedValue<QSize>::push_table(st, index);
+	break;
+      case QMetaType::QSizeF:
+	PackedValue<QSizeF>::push_table(st, index);
+	break;
+      case QMetaType::QRect:
+	PackedValue<QRect>::push_table(st, index);
+	break;
+      case QMetaType::QRectF:
+	PackedValue<QRectF>::push_table(st, index);
+	break;
+      case QMetaType::QColor:
+	PackedValue<QColor>::push_table(st, index);
+	break;
+      default:
+	return;
+      }
+
+    lua_replace(st, index);
+  }
+
+}
@@ -19,6 +19,15 @@
 */
 
 #include <cstring>
+#include <cstdlib>
+
+#include <QPoint>
+#include <QPointF>
+#include <QSize>
+#include <QSizeF>
+#include <QRect>
+#include <QRectF>
+#include <QColor>
 
 #include <internal/QObjectWrapper>
 
@@ -27,13 +36,143 @@
 
 namespace QtLua {
 
+  /* Read property value directly in a stack allocated object,
+     without going through a QVariant. */
+  template <typename X>
+  static inline Value fast_read(QObjectWrapper &qow, int type, int index)
+  {
+    X data = X();
+    QVariant variant;
+    int status = -1;
+    void *argv[] = { &data, &variant, &status };
+
+    QMetaObject::metacall(&qow.get_object(), QMetaObject::ReadProperty, index, argv);
+
+    // value has been stored in the variant by a dynamic meta object
+    if (status != -1)
+      return Value(qow.get_state(), variant);
+
+    return QMetaValue::raw_get_object(qow.get_state(), type, argv[0]);
+  }
+
+  /* Convert lua value in a stack allocated object and write property
+     value without going through a QVariant. */
+  template <typename X>
+  static inline bool fast_write(QObjectWrapper &qow, int type, int index, const Value &value)
+  {
+    X data = X();
+    QMetaValue::raw_set_object(type, &data, value);
+
+    QVariant variant;
+    int status = -1;
+    int flags = 0;
+    void *argv[] = { &data, &variant, &status, &flags };
+
+    QMetaObject::metacall(&qow.get_object(), QMetaObject::WriteProperty, index, argv);
+
+    return status != 0;
+  }
+
   Property::Property(const QMetaObject *mo, int index)
-    : Member(mo, index)
+    : Member(mo, index),
+      _fast_type(0),
+      _fast_read(false),
+      _fast_write(false)
   { 
+    QMetaProperty mp = mo->property(index);
+
+    // enum properties need key names handling done by QMetaProperty
+    if (mp.isEnumType() || mp.isFlagType())
+      return;
+
+    switch (mp.userType())
+      {
+      case QMetaType::Bool:
+      case QMetaType::Int:
+      case QMetaType::UInt:
+      case QMetaType::LongLong:
+      case QMetaType::ULongLong:
+      case QMetaType::Double:
+      case QMetaType::Float:
+      case QMetaType::QString:
+      case QMetaType::QPoint:
+      case QMetaType::QPointF:
+      case QMetaType::QSize:
+      case QMetaType::QSizeF:
+      case QMetaType::QRect:
+      case QMetaType::QRectF:
+      case QMetaType::QColor:
+	_fast_type = mp.userType();
+	_fast_read = mp.isReadable();
+	_fast_write = mp.isWritable();
+      default:
+	break;
+      }
   }
 
   void Property::assign(QObjectWrapper &qow, const Value &value)
   {
+    if (_fast_write && value.type() != Value::TNil)
+      {
+	bool done;
+
+	switch (_fast_type)
+	  {
+	  case QMetaType::Bool:
+	    done = fast_write<bool>(qow, _fast_type, _index, value);
+	    break;
+	  case QMetaType::Int:
+	    done = fast_write<int>(qow, _fast_type, _index, value);
+	    break;
+	  case QMetaType::UInt:
+	    done = fast_write<unsigned int>(qow, _fast_type, _index, value);
+	    break;
+	  case QMetaType::LongLong:
+	    done = fast_write<qlonglong>(qow, _fast_type, _index, value);
+	    break;
+	  case QMetaType::ULongLong:
+	    done = fast_write<qulonglong>(qow, _fast_type, _index, value);
+	    break;
+	  case QMetaType::Double:
+	    done = fast_write<double>(qow, _fast_type, _index, value);
+	    break;
+	  case QMetaType::Float:
+	    done = fast_write<float>(qow, _fast_type, _index, value);
+	    break;
+	  case QMetaType::QString:
+	    done = fast_write<QString>(qow, _fast_type, _index, value);
+	    break;
+	  case QMetaType::QPoint:
+	    done = fast_write<QPoint>(qow, _fast_type, _index, value);
+	    break;
+	  case QMetaType::QPointF:
+	    done = fast_write<QPointF>(qow, _fast_type, _index, value);
+	    break;
+	  case QMetaType::QSize:
+	    done = fast_write<QSize>(qow, _fast_type, _index, value);
+	    break;
+	  case QMetaType::QSizeF:
+	    done = fast_write<QSizeF>(qow, _fast_type, _index, value);
+	    break;
+	  case QMetaType::QRect:
+	    done = fast_write<QRect>(qow, _fast_type, _index, value);
+	    break;
+	  case QMetaType::QRectF:
+	    done = fast_write<QRectF>(qow, _fast_type, _index, value);
+	    break;
+	  case QMetaType::QColor:
+	    done = fast_write<QColor>(qow, _fast_type, _index, value);
+	    break;
+	  default:
+	    std::abort();
+	  }
+
+	if (!done)
+	  QTLUA_THROW(QtLua::Property, "Unable to set value of the `%' QObject property.",
+		      .arg(_mo->property(_index).name()));
+	return;
+      }
+
     QMetaProperty mp = _mo->property(_index);
     QObject &obj = qow.get_object();
 
@@ -54,6 +193,45 @@ namespace QtLua {
 
   Value Property::access(QObjectWrapper &qow)
   {
+    if (_fast_read)
+      {
+	switch (_fast_type)
+	  {
+	  case QMetaType::Bool:
+	    return fast_read<bool>(qow, _fast_type, _index);
+	  case QMetaType::Int:
+	    return fast_read<int>(qow, _fast_type, _index);
+	  case QMetaType::UInt:
+	    return fast_read<unsigned int>(qow, _fast_type, _index);
+	  case QMetaType::LongLong:
+	    return fast_read<qlonglong>(qow, _fast_type, _index);
+	  case QMetaType::ULongLong:
+	    return fast_read<qulonglong>(qow, _fast_type, _index);
+	  case QMetaType::Double:
+	    return fast_read<double>(qow, _fast_type, _index);
+	  case QMetaType::Float:
+	    return fast_read<float>(qow, _fast_type, _index);
+	  case QMetaType::QString:
+	    return fast_read<QString>(qow, _fast_type, _index);
+	  case QMetaType::QPoint:
+	    return fast_read<QPoint>(qow, _fast_type, _index);
+	  case QMetaType::QPointF:
+	    return fast_read<QPointF>(qow, _fast_type, _index);
+	  case QMetaType::QSize:
+	    return fast_read<QSize>(qow, _fast_type, _index);
+	  case QMetaType::QSizeF:
+	    return fast_read<QSizeF>(qow, _fast_type, _index);
+	  case QMetaType::QRect:
+	    return fast_read<QRect>(qow, _fast_type, _index);
+	  case QMetaType::QRectF:
+	    return fast_read<QRectF>(qow, _fast_type, _index);
+	  case QMetaType::QColor:
+	    return fast_read<QColor>(qow, _fast_type, _index);
+	  default:
+	    std::abort();
+	  }
+      }
+
     QMetaProperty mp = _mo->property(_index);
     QObject &obj = qow.get_object();
 
@@ -33,9 +33,76 @@ namespace QtLua {
   QMetaObjectWrapper::QMetaObjectWrapper(const QMetaObject *mo, qobject_creator *creator)
     : _mo(mo)
     , _creator(creator)
+    , _ctors_init(false)
   {
   }
 
+  void QMetaObjectWrapper::init_constructors() const
+  {
+#if QT_VERSION >= 0x040500
+    if (_ctors_init)
+      return;
+
+    // resolve parameters types of Q_INVOKABLE constructors
+    for (int j = 0; j < _mo->constructorCount(); j++)
+      {
+	QMetaMethod mm = _mo->constructor(j);
+	Constructor ctor;
+
+	ctor._index = j;
+	foreach(const QByteArray &pt, mm.parameterTypes())
+	  ctor._types.push_back(QMetaType::type(pt.constData()));
+
+	_ctors.push_back(ctor);
+      }
+
+    _ctors_init = true;
+#endif
+  }
+
+  int QMetaObjectWrapper::find_constructor(const Value::List &lua_args) const
+  {
+    int argc = lua_args.size() - 1;
+
+    if (argc > 10)
+      return -1;
+
+    // build a signature from lua argument types
+    quint64 sig = argc;
+    for (int i = 0; i < argc; i++)
+      sig |= (quint64)(lua_args[i+1].type() + 1) << (4 + i * 4);
+
+    QHash<quint64, int>::const_iterator c = _ctors_cache.find(sig);
+    if (c != _ctors_cache.end())
+      return c.value();
+
+    init_constructors();
+
+    int index = -1;
+
+    for (int j = 0; j < _ctors.size(); j++)
+      {
+	const Constructor &ctor = _ctors[j];
+
+	if (ctor._types.size() != argc)
+	  continue;
+
+	int i;
+	for (i = 0; i < argc; i++)
+	  if (!QMetaValue::check_type(ctor._types[i], lua_args[i+1].type()))
+	    break;
+
+	if (i == argc)
+	  {
+	    index = j;
+	    break;
+	  }
+      }
+
+    _ctors_cache.insert(sig, index);
+    return index;
+  }
+
   QObject * QMetaObjectWrapper::create(const Value::List &lua_args) const
   {
     // try constructor without argument if available
@@ -47,30 +114,39 @@ namespace QtLua {
     void *qt_args[11];
     qt_args[0] = &obj;
 
-    // iterate over Q_INVOKABLE constructors
-    for (int j = 0; j < _mo->constructorCount(); j++)
+    // use constructor with exactly matching parameters types
+    int j = find_constructor(lua_args);
+
+    if (j >= 0)
       {
-	QMetaMethod mm = _mo->constructor(j);
+	PoolArray<QMetaValue, 11> args;
+	const QVector<int> &types = _ctors[j]._types;
 
-	int i;
+	for (int i = 0; i < types.size(); i++)
+	  qt_args[i+1] = args.create(types[i], lua_args[i+1]).get_data();
 
-	QList<QByteArray> ptlist = mm.parameterTypes();
+	_mo->static_metacall(QMetaObject::CreateInstance, _ctors[j]._index, qt_args);
 
-	if (ptlist.size() != lua_args.size() - 1)
+	return obj;
+      }
+
+    // fallback to the first constructor which accepts argument
+    // conversions, lua strings may be converted to numbers for instance
+    foreach(const Constructor &ctor, _ctors)
+      {
+	if (ctor._types.size() != lua_args.size() - 1)
 	  continue;
 
 	PoolArray<QMetaValue, 11> args;
 
 	try {
-	  // get argument types
-	  for (i = 0; i < ptlist.size(); i++)
-	    qt_args[i+1] = args.create(QMetaType::type(ptlist[i].constData()),
-				     lua_args[i+1]).get_data();
+	  for (int i = 0; i < ctor._types.size(); i++)
+	    qt_args[i+1] = args.create(ctor._types[i], lua_args[i+1]).get_data();
 	} catch (...) {
 	  continue;
 	}
 
-	_mo->static_metacall(QMetaObject::CreateInstance, j, qt_args);
+	_mo->static_metacall(QMetaObject::CreateInstance, ctor._index, qt_args);
 
 	return obj;
       }
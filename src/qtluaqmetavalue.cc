@@ -18,6 +18,8 @@
 
 */
 
+#include <climits>
+
 #include <QSize>
 #include <QSizeF>
 #include <QRect>
@@ -32,304 +34,820 @@
 
 #include <QtLua/String>
 #include <QtLua/MetaType>
+#include <QtLua/Blob>
 #include <internal/QObjectWrapper>
 
 #include <internal/QMetaValue>
+#include <internal/PackedValue>
 
-namespace QtLua {
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
 
-  metatype_map_t types_map;
+namespace QtLua {
 
   static int ud_ref_type = qRegisterMetaType<Ref<UserData> >("QtLua::UserData::ptr");
 
-  Value QMetaValue::raw_get_object(State *ls, int type, const void *data)
+  ////////////////////////////////////////////////// Qt to lua
+
+  static Value get_void(State *ls, const void *data, metatype_void_t *mt)
   {
-    switch (type)
+    return Value(ls);
+  }
+
+  static Value get_bool(State *ls, const void *data, metatype_void_t *mt)
+  {
+    return Value(ls, (Value::Bool)*(const bool*)data);
+  }
+
+  template <typename X>
+  static Value get_number(State *ls, const void *data, metatype_void_t *mt)
+  {
+    return Value(ls, (double)*(const X*)data);
+  }
+
+  template <typename X>
+  static Value get_integer(State *ls, const void *data, metatype_void_t *mt)
+  {
+    return Value(ls, (long long)*(const X*)data);
+  }
+
+  static Value get_ulonglong(State *ls, const void *data, metatype_void_t *mt)
+  {
+    unsigned long long n = *(const unsigned long long*)data;
+
+    // values out of lua integer range are stored as float
+    if (n > (unsigned long long)LLONG_MAX)
+      return Value(ls, (double)n);
+    return Value(ls, (long long)n);
+  }
+
+  static Value get_qchar(State *ls, const void *data, metatype_void_t *mt)
+  {
+    return Value(ls, (int)reinterpret_cast<const QChar*>(data)->unicode());
+  }
+
+  static Value get_qstring(State *ls, const void *data, metatype_void_t *mt)
+  {
+    return Value(ls, String(*reinterpret_cast<const QString*>(data)));
+  }
+
+  static Value get_qbytearray(State *ls, const void *data, metatype_void_t *mt)
+  {
+    const QByteArray *ba = reinterpret_cast<const QByteArray*>(data);
+
+    if (ls->is_bytearray_blob_enabled())
+      return Value(ls, QTLUA_REFNEW(Blob, *ba));
+
+    return Value(ls, String(*ba));
+  }
+
+  static Value get_qobject(State *ls, const void *data, metatype_void_t *mt)
+  {
+    return Value(ls, QObjectWrapper::get_wrapper(ls, *(QObject* const*)data));
+  }
+
+#if QT_VERSION < 0x050000
+  static Value get_qwidget(State *ls, const void *data, metatype_void_t *mt)
+  {
+    return Value(ls, QObjectWrapper::get_wrapper(ls, *(QWidget* const*)data));
+  }
+#endif
+
+  template <typename X>
+  static Value get_packed(State *ls, const void *data, metatype_void_t *mt)
+  {
+    return PackedValue<X>::new_value(ls, *reinterpret_cast<const X*>(data));
+  }
+
+  static Value get_ud_ref(State *ls, const void *data, metatype_void_t *mt)
+  {
+    const Ref<UserData> &ud = *(const Ref<UserData>*)data;
+    if (ud.valid())
+      return Value(ls, ud);
+    else
+      return Value(ls);
+  }
+
+  Value QMetaValue::user_qt2lua(State *ls, const void *data, metatype_void_t *mt)
+  {
+    return mt->qt2lua(ls, data);
+  }
+
+  ////////////////////////////////////////////////// lua to Qt
+
+  static bool set_bool(void *data, const Value &v, metatype_void_t *mt)
+  {
+    *(bool*)data = v.to_boolean();
+    return true;
+  }
+
+  template <typename X>
+  static bool set_number(void *data, const Value &v, metatype_void_t *mt)
+  {
+    *(X*)data = v.to_number();
+    return true;
+  }
+
+  template <typename X>
+  static bool set_integer(void *data, const Value &v, metatype_void_t *mt)
+  {
+    *(X*)data = v.to_longlong();
+    return true;
+  }
+
+  static bool set_ulonglong(void *data, const Value &v, metatype_void_t *mt)
+  {
+    double n = v.to_number();
+
+    if (n > (double)LLONG_MAX)
+      *(unsigned long long*)data = n;
+    else
+      *(unsigned long long*)data = v.to_longlong();
+    return true;
+  }
+
+  static bool set_qchar(void *data, const Value &v, metatype_void_t *mt)
+  {
+    *reinterpret_cast<QChar*>(data) = QChar((unsigned short)v.to_number());
+    return true;
+  }
+
+  static bool set_qstring(void *data, const Value &v, metatype_void_t *mt)
+  {
+    *reinterpret_cast<QString*>(data) = v.to_qstring();
+    return true;
+  }
+
+  static bool set_qbytearray(void *data, const Value &v, metatype_void_t *mt)
+  {
+    if (v.type() == Value::TUserData)
       {
-      case QMetaType::Void:
-	return Value(ls);
-      case QMetaType::Bool:
-	return Value(ls, (Value::Bool)*(bool*)data);
-      case QMetaType::Int:
-	return Value(ls, (double)*(int*)data);
-      case QMetaType::UInt:
-	return Value(ls, (double)*(unsigned int*)data);
-      case QMetaType::Long:
-	return Value(ls, (double)*(long*)data);
-      case QMetaType::LongLong:
-	return Value(ls, (double)*(long long*)data);
-      case QMetaType::Short:
-	return Value(ls, (double)*(short*)data);
-      case QMetaType::Char:
-	return Value(ls, (double)*(char*)data);
-      case QMetaType::ULong:
-	return Value(ls, (double)*(unsigned long*)data);
-      case QMetaType::ULongLong:
-	return Value(ls, (double)*(unsigned long long*)data);
-      case QMetaType::UShort:
-	return Value(ls, (double)*(unsigned short*)data);
-      case QMetaType::UChar:
-	return Value(ls, (double)*(unsigned char*)data);
-      case QMetaType::Double:
-	return Value(ls, *(double*)data);
-      case QMetaType::Float:
-	return Value(ls, *(float*)data);
-      case QMetaType::QChar:
-	return Value(ls, (double)reinterpret_cast<const QChar*>(data)->unicode());
-      case QMetaType::QString:
-	return Value(ls, String(*reinterpret_cast<const QString*>(data)));
-      case QMetaType::QStringList: {
-	Value value(Value::new_table(ls));
-	const QStringList *qsl = reinterpret_cast<const QStringList*>(data);
-	for (int i = 0; i < qsl->size(); i++)
-	  value[i+1] = String(qsl->at(i));
-	return value;
+	// share storage of blob objects
+	Blob::ptr blob = v.to_userdata().dynamiccast<Blob>();
+	if (!blob.valid())
+	  return false;
+	*reinterpret_cast<QByteArray*>(data) = blob->get_bytearray();
+	return true;
       }
-      case QMetaType::QByteArray:
-	return Value(ls, String(*reinterpret_cast<const QByteArray*>(data)));
-      case QMetaType::QObjectStar:
-	return Value(ls, QObjectWrapper::get_wrapper(ls, *(QObject**)data));
+
+    *reinterpret_cast<QByteArray*>(data) = v.to_string();
+    return true;
+  }
+
+  static bool set_qobject(void *data, const Value &v, metatype_void_t *mt)
+  {
+    if (v.is_nil())
+      *reinterpret_cast<QObject**>(data) = 0;
+    else
+      *reinterpret_cast<QObject**>(data) = &v.to_userdata_cast<QObjectWrapper>()->get_object();
+    return true;
+  }
+
 #if QT_VERSION < 0x050000
-      case QMetaType::QWidgetStar:
-	return Value(ls, QObjectWrapper::get_wrapper(ls, *(QWidget**)data));
-#endif
-      case QMetaType::QSize: {
-	Value value(Value::new_table(ls));
-	const QSize *size = reinterpret_cast<const QSize*>(data);
-	value[1] = size->width();
-	value[2] = size->height();
-	return value;
+  static bool set_qwidget(void *data, const Value &v, metatype_void_t *mt)
+  {
+    if (v.is_nil())
+      {
+	*reinterpret_cast<QWidget**>(data) = 0;
+	return true;
       }
-      case QMetaType::QSizeF: {
-	Value value(Value::new_table(ls));
-	const QSizeF *size = reinterpret_cast<const QSizeF*>(data);
-	value[1] = size->width();
-	value[2] = size->height();
-	return value;
+    QObject *obj = &v.to_userdata_cast<QObjectWrapper>()->get_object();
+    QWidget *w = dynamic_cast<QWidget*>(obj);
+    if (obj && !w)
+      QTLUA_THROW(QtLua::MetaType, "Can not convert a non-QObject lua value to a QWidget.");
+    *reinterpret_cast<QWidget**>(data) = w;
+    return true;
+  }
+#endif
+
+  template <typename X>
+  static bool set_packed(void *data, const Value &v, metatype_void_t *mt)
+  {
+    PackedValue<X>::get_value(*reinterpret_cast<X*>(data), v);
+    return true;
+  }
+
+  static bool set_qsizepolicy(void *data, const Value &v, metatype_void_t *mt)
+  {
+    QSizePolicy *sp = reinterpret_cast<QSizePolicy*>(data);
+    sp->setHorizontalStretch(v.at(1).to_number());
+    sp->setVerticalStretch(v.at(2).to_number());
+    sp->setHorizontalPolicy((QSizePolicy::Policy)v.at(3).to_integer());
+    sp->setVerticalPolicy((QSizePolicy::Policy)v.at(4).to_integer());
+    return true;
+  }
+
+  static bool set_qicon(void *data, const Value &v, metatype_void_t *mt)
+  {
+    *reinterpret_cast<QIcon*>(data) = QIcon(v.to_string());
+    return true;
+  }
+
+  static bool set_qcolor(void *data, const Value &v, metatype_void_t *mt)
+  {
+    QColor *color = reinterpret_cast<QColor*>(data);
+
+    if (v.type() == Value::TTable)
+      *color = QColor(v.at(1).to_integer(), v.at(2).to_integer(), v.at(3).to_integer());
+    else
+      PackedValue<QColor>::get_value(*color, v);
+    return true;
+  }
+
+  static bool set_ud_ref(void *data, const Value &v, metatype_void_t *mt)
+  {
+    *reinterpret_cast<Ref<UserData>*>(data) = v.to_userdata();
+    return true;
+  }
+
+  bool QMetaValue::user_lua2qt(void *data, const Value &v, metatype_void_t *mt)
+  {
+    return mt->lua2qt(data, v);
+  }
+
+  ////////////////////////////////////////////////// bulk containers
+
+  /** Maximum nesting of containers, also used to detect reference cycles */
+  static const int container_max_depth = 64;
+
+  static inline void table_new(lua_State *st, int narr, int nrec)
+  {
+#if LUA_VERSION_NUM < 501
+    lua_newtable(st);
+#else
+    lua_createtable(st, narr, nrec);
+#endif
+  }
+
+  int QMetaValue::raw_len(lua_State *st, int index)
+  {
+#if LUA_VERSION_NUM < 501
+    return luaL_getn(st, index);
+#elif LUA_VERSION_NUM < 502
+    return (int)lua_objlen(st, index);
+#else
+    return (int)lua_rawlen(st, index);
+#endif
+  }
+
+  static inline void push_qstring(lua_State *st, const QString &str)
+  {
+    QByteArray s(str.toUtf8());
+    lua_pushlstring(st, s.constData(), s.size());
+  }
+
+  template <class M>
+  void QMetaValue::push_map(State *ls, lua_State *st, const M &map, int depth)
+  {
+    table_new(st, 0, map.size());
+
+    for (typename M::const_iterator i = map.begin(); i != map.end(); ++i)
+      {
+	push_qstring(st, i.key());
+	push_container(ls, st, i.value().userType(), i.value().constData(), depth + 1);
+	lua_rawset(st, -3);
       }
-      case QMetaType::QRect: {
-	Value value(Value::new_table(ls));
-	const QRect *rect = reinterpret_cast<const QRect*>(data);
-	value[1] = rect->x();
-	value[2] = rect->y();
-	value[3] = rect->width();
-	value[4] = rect->height();
-	return value;
+  }
+
+  void QMetaValue::push_container(State *ls, lua_State *st, int type, const void *data, int depth)
+  {
+    if (depth > container_max_depth)
+      QTLUA_THROW(QtLua::MetaType, "Containers nested too deeply, unable to convert to a lua value.");
+
+    if (!lua_checkstack(st, 4))
+      QTLUA_THROW(QtLua::MetaType, "Unable to extend the lua stack.");
+
+    switch (type)
+      {
+      case QMetaType::QStringList: {
+	const QStringList &l = *reinterpret_cast<const QStringList*>(data);
+	table_new(st, l.size(), 0);
+	for (int i = 0; i < l.size(); i++)
+	  {
+	    push_qstring(st, l[i]);
+	    lua_rawseti(st, -2, i + 1);
+	  }
+	return;
       }
-      case QMetaType::QRectF: {
-	Value value(Value::new_table(ls));
-	const QRectF *rect = reinterpret_cast<const QRectF*>(data);
-	value[1] = rect->x();
-	value[2] = rect->y();
-	value[3] = rect->width();
-	value[4] = rect->height();
-	return value;
+
+      case QMetaType::QVariantList: {
+	const QVariantList &l = *reinterpret_cast<const QVariantList*>(data);
+	table_new(st, l.size(), 0);
+	for (int i = 0; i < l.size(); i++)
+	  {
+	    push_container(ls, st, l[i].userType(), l[i].constData(), depth + 1);
+	    lua_rawseti(st, -2, i + 1);
+	  }
+	return;
       }
-      case QMetaType::QPoint: {
-	Value value(Value::new_table(ls));
-	const QPoint *point = reinterpret_cast<const QPoint*>(data);
-	value[1] = point->x();
-	value[2] = point->y();
-	return value;
+
+      case QMetaType::QVariantMap:
+	push_map(ls, st, *reinterpret_cast<const QVariantMap*>(data), depth);
+	return;
+
+      case QMetaType::QVariantHash:
+	push_map(ls, st, *reinterpret_cast<const QVariantHash*>(data), depth);
+	return;
+
+      default:
+	raw_push_object(ls, st, type, data);
+	return;
       }
-      case QMetaType::QPointF: {
-	Value value(Value::new_table(ls));
-	const QPointF *point = reinterpret_cast<const QPointF*>(data);
-	value[1] = point->x();
-	value[2] = point->y();
-	return value;
+  }
+
+  template <int type>
+  Value QMetaValue::container_qt2lua(State *ls, const void *data, metatype_void_t *mt)
+  {
+    lua_State *st = ls->get_lua_state();
+    int top = lua_gettop(st);
+
+    try {
+      push_container(ls, st, type, data, 0);
+    } catch (...) {
+      lua_settop(st, top);
+      throw;
+    }
+
+    Value res(-1, ls);
+    lua_pop(st, 1);
+    return res;
+  }
+
+  template <class M>
+  void QMetaValue::get_map(M &map, State *ls, lua_State *st, int index, QSet<const void*> &visited)
+  {
+    lua_pushnil(st);
+    while (lua_next(st, index))
+      {
+	QString key;
+
+	// do not use lua_tolstring on key as it would confuse lua_next
+	switch (lua_type(st, -2))
+	  {
+	  case LUA_TSTRING: {
+	    size_t len;
+	    const char *s = lua_tolstring(st, -2, &len);
+	    key = QString::fromUtf8(s, len);
+	    break;
+	  }
+	  case LUA_TNUMBER:
+#if LUA_VERSION_NUM >= 503
+	    if (lua_isinteger(st, -2))
+	      {
+		key = QString::number((qlonglong)lua_tointeger(st, -2));
+		break;
+	      }
+#endif
+	    key = QString::number(lua_tonumber(st, -2));
+	    break;
+	  default:
+	    lua_pop(st, 1);
+	    continue;
+	  }
+
+	map.insert(key, get_variant(ls, st, lua_gettop(st), visited));
+	lua_pop(st, 1);
       }
-      case QMetaType::QColor: {
-	Value value(Value::new_table(ls));
-	const QColor *color = reinterpret_cast<const QColor*>(data);
-	value[1] = color->red();
-	value[2] = color->green();
-	value[3] = color->blue();
-	return value;
+  }
+
+  QVariant QMetaValue::get_variant(State *ls, lua_State *st, int index, QSet<const void*> &visited)
+  {
+    switch (lua_type(st, index))
+      {
+      case LUA_TNONE:
+      case LUA_TNIL:
+	return QVariant();
+
+      case LUA_TBOOLEAN:
+	return QVariant((bool)lua_toboolean(st, index));
+
+      case LUA_TNUMBER:
+#if LUA_VERSION_NUM >= 503
+	if (lua_isinteger(st, index))
+	  return QVariant((qlonglong)lua_tointeger(st, index));
+#endif
+	return QVariant((double)lua_tonumber(st, index));
+
+      case LUA_TSTRING: {
+	size_t len;
+	const char *s = lua_tolstring(st, index, &len);
+	return QVariant(QString::fromUtf8(s, len));
       }
+
+      case LUA_TTABLE:
+	if (QMetaValue::raw_len(st, index) > 0)
+	  {
+	    QVariantList l;
+	    get_container(QMetaType::QVariantList, &l, ls, st, index, visited);
+	    return l;
+	  }
+	else
+	  {
+	    QVariantMap m;
+	    get_container(QMetaType::QVariantMap, &m, ls, st, index, visited);
+	    return m;
+	  }
+
+      case LUA_TUSERDATA:
+	if (int type = packed_value_type(st, index))
+	  return QMetaValue(type, Value(index, ls)).to_qvariant();
+
       default:
-	if (type == ud_ref_type)
+	return Value(index, ls).to_qvariant();
+      }
+  }
+
+  bool QMetaValue::get_container(int type, void *data, State *ls, lua_State *st, int index,
+				 QSet<const void*> &visited)
+  {
+    if (lua_type(st, index) != LUA_TTABLE)
+      return false;
+
+    const void *p = lua_topointer(st, index);
+
+    if (visited.contains(p))
+      QTLUA_THROW(QtLua::MetaType, "Can not convert a recursive `lua::table' value to a Qt container.");
+
+    if (visited.size() >= container_max_depth)
+      QTLUA_THROW(QtLua::MetaType, "Tables nested too deeply, unable to convert to a Qt container.");
+
+    if (!lua_checkstack(st, 4))
+      QTLUA_THROW(QtLua::MetaType, "Unable to extend the lua stack.");
+
+    bool res = true;
+    visited.insert(p);
+
+    switch (type)
+      {
+      case QMetaType::QStringList: {
+	QStringList &l = *reinterpret_cast<QStringList*>(data);
+	int len = QMetaValue::raw_len(st, index);
+	l.reserve(len);
+	for (int i = 1; i <= len; i++)
 	  {
-	    const Ref<UserData> &ud = *(Ref<UserData>*)data;
-	    if (ud.valid())
-	      return Value(ls, ud);
-	    else
-	      return Value(ls);
+	    lua_rawgeti(st, index, i);
+	    switch (lua_type(st, -1))
+	      {
+	      case LUA_TSTRING:
+	      case LUA_TNUMBER: {
+		size_t slen;
+		const char *s = lua_tolstring(st, -1, &slen);
+		l.push_back(QString::fromUtf8(s, slen));
+		lua_pop(st, 1);
+		break;
+	      }
+	      default: {
+		int t = lua_type(st, -1);
+		lua_pop(st, 1);
+		QTLUA_THROW(QtLua::MetaType, "Can not convert a `lua::%' table entry to a QString.",
+			    .arg(lua_typename(st, t)));
+	      }
+	      }
 	  }
+	break;
+      }
+
+      case QMetaType::QVariantList: {
+	QVariantList &l = *reinterpret_cast<QVariantList*>(data);
+	int len = QMetaValue::raw_len(st, index);
+	l.reserve(len);
+	for (int i = 1; i <= len; i++)
+	  {
+	    lua_rawgeti(st, index, i);
+	    l.push_back(get_variant(ls, st, lua_gettop(st), visited));
+	    lua_pop(st, 1);
+	  }
+	break;
+      }
 
-	metatype_map_t::const_iterator i = types_map.find(type);
+      case QMetaType::QVariantMap:
+	get_map(*reinterpret_cast<QVariantMap*>(data), ls, st, index, visited);
+	break;
 
-	if (i != types_map.end())
-	  return i.value()->qt2lua(ls, data);
+      case QMetaType::QVariantHash:
+	get_map(*reinterpret_cast<QVariantHash*>(data), ls, st, index, visited);
+	break;
 
-	return Value(ls);
+      default:
+	res = false;
+	break;
       }
+
+    visited.remove(p);
+    return res;
   }
 
-  void QMetaValue::raw_set_object(int type, void *data, const Value &v)
+  template <int type>
+  bool QMetaValue::container_lua2qt(void *data, const Value &v, metatype_void_t *mt)
+  {
+    State *ls = v.get_state();
+
+    if (!ls)
+      return false;
+
+    lua_State *st = ls->get_lua_state();
+    int top = lua_gettop(st);
+    bool res;
+
+    QSet<const void*> visited;
+
+    v.push_value(st);
+
+    try {
+      res = get_container(type, data, ls, st, top + 1, visited);
+    } catch (...) {
+      lua_settop(st, top);
+      throw;
+    }
+
+    lua_settop(st, top);
+    return res;
+  }
+
+  ////////////////////////////////////////////////// converters table
+
+  static void set_converter(QVector<QMetaValue::Converter> &table, int type,
+			    QMetaValue::qt2lua_t *qt2lua, QMetaValue::lua2qt_t *lua2qt)
+  {
+    if (type >= table.size())
+      table.resize(type + 1);
+
+    QMetaValue::Converter &c = table[type];
+    c._qt2lua = qt2lua;
+    c._lua2qt = lua2qt;
+    c._mt = 0;
+  }
+
+  static QVector<QMetaValue::Converter> build_converters()
+  {
+    QVector<QMetaValue::Converter> table;
+
+    set_converter(table, QMetaType::Void, &get_void, 0);
+    set_converter(table, QMetaType::Bool, &get_bool, &set_bool);
+    set_converter(table, QMetaType::Int, &get_integer<int>, &set_integer<int>);
+    set_converter(table, QMetaType::UInt, &get_integer<unsigned int>, &set_integer<unsigned int>);
+    set_converter(table, QMetaType::Long, &get_integer<long>, &set_integer<long>);
+    set_converter(table, QMetaType::LongLong, &get_integer<long long>, &set_integer<long long>);
+    set_converter(table, QMetaType::Short, &get_integer<short>, &set_integer<short>);
+    set_converter(table, QMetaType::Char, &get_integer<char>, &set_integer<char>);
+    set_converter(table, QMetaType::ULong, &get_integer<unsigned long>, &set_integer<unsigned long>);
+    set_converter(table, QMetaType::ULongLong, &get_ulonglong, &set_ulonglong);
+    set_converter(table, QMetaType::UShort, &get_integer<unsigned short>, &set_integer<unsigned short>);
+    set_converter(table, QMetaType::UChar, &get_integer<unsigned char>, &set_integer<unsigned char>);
+    set_converter(table, QMetaType::Double, &get_number<double>, &set_number<double>);
+    set_converter(table, QMetaType::Float, &get_number<float>, &set_number<float>);
+    set_converter(table, QMetaType::QChar, &get_qchar, &set_qchar);
+    set_converter(table, QMetaType::QString, &get_qstring, &set_qstring);
+    set_converter(table, QMetaType::QStringList, &container_qt2lua<QMetaType::QStringList>,
+	      &container_lua2qt<QMetaType::QStringList>);
+    set_converter(table, QMetaType::QVariantList, &container_qt2lua<QMetaType::QVariantList>,
+	      &container_lua2qt<QMetaType::QVariantList>);
+    set_converter(table, QMetaType::QVariantMap, &container_qt2lua<QMetaType::QVariantMap>,
+	      &container_lua2qt<QMetaType::QVariantMap>);
+    set_converter(table, QMetaType::QVariantHash, &container_qt2lua<QMetaType::QVariantHash>,
+	      &container_lua2qt<QMetaType::QVariantHash>);
+    set_converter(table, QMetaType::QByteArray, &get_qbytearray, &set_qbytearray);
+    set_converter(table, QMetaType::QObjectStar, &get_qobject, &set_qobject);
+#if QT_VERSION < 0x050000
+    set_converter(table, QMetaType::QWidgetStar, &get_qwidget, &set_qwidget);
+#endif
+    set_converter(table, QMetaType::QSize, &get_packed<QSize>, &set_packed<QSize>);
+    set_converter(table, QMetaType::QSizeF, &get_packed<QSizeF>, &set_packed<QSizeF>);
+    set_converter(table, QMetaType::QSizePolicy, 0, &set_qsizepolicy);
+    set_converter(table, QMetaType::QRect, &get_packed<QRect>, &set_packed<QRect>);
+    set_converter(table, QMetaType::QRectF, &get_packed<QRectF>, &set_packed<QRectF>);
+    set_converter(table, QMetaType::QPoint, &get_packed<QPoint>, &set_packed<QPoint>);
+    set_converter(table, QMetaType::QPointF, &get_packed<QPointF>, &set_packed<QPointF>);
+    set_converter(table, QMetaType::QIcon, 0, &set_qicon);
+    set_converter(table, QMetaType::QColor, &get_packed<QColor>, &set_qcolor);
+    set_converter(table, qRegisterMetaType<Ref<UserData> >("QtLua::UserData::ptr"),
+	      &get_ud_ref, &set_ud_ref);
+
+    return table;
+  }
+
+  QVector<QMetaValue::Converter> & QMetaValue::converters()
+  {
+    // built in the initializer so that concurrent first calls are
+    // serialized by the compiler; user types may still be registered
+    // from other static constructors.
+    static QVector<Converter> table = build_converters();
+
+    return table;
+  }
+
+  void metatype_register(int type, metatype_void_t *mt)
+  {
+    QVector<QMetaValue::Converter> &table = QMetaValue::converters();
+
+    if (type < table.size())
+      {
+	QMetaValue::Converter &c = table[type];
+
+	if (c._mt)
+	  QTLUA_THROW(QtLua::MetaType, "A lua conversion handler is already registered for type handle `%'.", .arg(type));
+
+	// builtin conversion functions take precedence
+	c._mt = mt;
+	if (c._qt2lua || c._lua2qt)
+	  return;
+      }
+    else
+      {
+	table.resize(type + 1);
+      }
+
+    QMetaValue::Converter &c = table[type];
+    c._qt2lua = &QMetaValue::user_qt2lua;
+    c._lua2qt = &QMetaValue::user_lua2qt;
+    c._mt = mt;
+  }
+
+  void metatype_unregister(int type)
+  {
+    QVector<QMetaValue::Converter> &table = QMetaValue::converters();
+
+    if (type >= table.size())
+      return;
+
+    QMetaValue::Converter &c = table[type];
+
+    if (c._qt2lua == &QMetaValue::user_qt2lua)
+      {
+	c._qt2lua = 0;
+	c._lua2qt = 0;
+      }
+    c._mt = 0;
+  }
+
+  Value QMetaValue::raw_get_object(State *ls, int type, const void *data)
+  {
+    const Converter *c = get_converter(type);
+
+    if (c && c->_qt2lua)
+      return c->_qt2lua(ls, data, c->_mt);
+
+    return Value(ls);
+  }
+
+  void QMetaValue::raw_push_object(State *ls, lua_State *st, int type, const void *data)
   {
     switch (type)
       {
+      case QMetaType::Void:
+	lua_pushnil(st);
+	return;
       case QMetaType::Bool:
-	*(bool*)data = v.to_boolean();
-	break;
+	lua_pushboolean(st, *(bool*)data);
+	return;
+#if LUA_VERSION_NUM >= 503
       case QMetaType::Int:
-	*(int*)data = v.to_number();
-	break;
+	lua_pushinteger(st, *(int*)data);
+	return;
       case QMetaType::UInt:
-	*(unsigned int*)data = v.to_number();
+	lua_pushinteger(st, *(unsigned int*)data);
+	return;
+      case QMetaType::LongLong:
+	lua_pushinteger(st, *(long long*)data);
+	return;
+      case QMetaType::ULongLong: {
+	unsigned long long n = *(unsigned long long*)data;
+	if (n > (unsigned long long)LLONG_MAX)
+	  lua_pushnumber(st, n);
+	else
+	  lua_pushinteger(st, n);
+	return;
+      }
+#else
+      case QMetaType::Int:
+	lua_pushnumber(st, *(int*)data);
+	return;
+      case QMetaType::UInt:
+	lua_pushnumber(st, *(unsigned int*)data);
+	return;
+      case QMetaType::LongLong:
+	lua_pushnumber(st, *(long long*)data);
+	return;
+      case QMetaType::ULongLong:
+	lua_pushnumber(st, *(unsigned long long*)data);
+	return;
+#endif
+      case QMetaType::Double:
+	lua_pushnumber(st, *(double*)data);
+	return;
+      case QMetaType::Float:
+	lua_pushnumber(st, *(float*)data);
+	return;
+      case QMetaType::QString: {
+	QByteArray s(reinterpret_cast<const QString*>(data)->toUtf8());
+	lua_pushlstring(st, s.constData(), s.size());
+	return;
+      }
+      case QMetaType::QByteArray: {
+	if (ls->is_bytearray_blob_enabled())
+	  break;
+	const QByteArray *s = reinterpret_cast<const QByteArray*>(data);
+	lua_pushlstring(st, s->constData(), s->size());
+	return;
+      }
+      case QMetaType::QSize:
+	PackedValue<QSize>::push_value(st, *(const QSize*)data);
+	return;
+      case QMetaType::QSizeF:
+	PackedValue<QSizeF>::push_value(st, *(const QSizeF*)data);
+	return;
+      case QMetaType::QRect:
+	PackedValue<QRect>::push_value(st, *(const QRect*)data);
+	return;
+      case QMetaType::QRectF:
+	PackedValue<QRectF>::push_value(st, *(const QRectF*)data);
+	return;
+      case QMetaType::QPoint:
+	PackedValue<QPoint>::push_value(st, *(const QPoint*)data);
+	return;
+      case QMetaType::QPointF:
+	PackedValue<QPointF>::push_value(st, *(const QPointF*)data);
+	return;
+      case QMetaType::QColor:
+	PackedValue<QColor>::push_value(st, *(const QColor*)data);
+	return;
+      default:
 	break;
+      }
+
+    raw_get_object(ls, type, data).push_value(st);
+  }
+
+  bool QMetaValue::check_type(int type, Value::ValueType t)
+  {
+    switch (type)
+      {
+      case QMetaType::Bool:
+	return t == Value::TBool || t == Value::TNil;
+      case QMetaType::Int:
+      case QMetaType::UInt:
       case QMetaType::Long:
-	*(long*)data = v.to_number();
-	break;
       case QMetaType::LongLong:
-	*(long long*)data = v.to_number();
-	break;
       case QMetaType::Short:
-	*(short*)data = v.to_number();
-	break;
       case QMetaType::Char:
-	*(char*)data = v.to_number();
-	break;
       case QMetaType::ULong:
-	*(unsigned long*)data = v.to_number();
-	break;
       case QMetaType::ULongLong:
-	*(unsigned long long*)data = v.to_number();
-	break;
       case QMetaType::UShort:
-	*(unsigned short*)data = v.to_number();
-	break;
       case QMetaType::UChar:
-	*(unsigned char*)data = v.to_number();
-	break;
       case QMetaType::Double:
-	*(double*)data = v.to_number();
-	break;
       case QMetaType::Float:
-	*(double*)data = v.to_number();
-	break;
       case QMetaType::QChar:
-	*reinterpret_cast<QChar*>(data) = QChar((unsigned short)v.to_number());
-	break;
+	return t == Value::TNumber;
       case QMetaType::QString:
-	*reinterpret_cast<QString*>(data) = v.to_qstring();
-	break;
-      case QMetaType::QStringList: {
-	QStringList *qsl = reinterpret_cast<QStringList*>(data);
-	try {
-	  for (int i = 1; ; i++)
-	    qsl->push_back(v.at(i).to_qstring());
-	} catch (String &e) {
-	}
-	break;
-      }
+	return t == Value::TString || t == Value::TNumber;
       case QMetaType::QByteArray:
-	*reinterpret_cast<QByteArray*>(data) = v.to_string();
-	break;
+	return t == Value::TString || t == Value::TNumber || t == Value::TUserData;
+      case QMetaType::QIcon:
+	return t == Value::TString;
       case QMetaType::QObjectStar:
-	if (v.is_nil())
-	  *reinterpret_cast<QObject**>(data) = 0;
-	else
-	  *reinterpret_cast<QObject**>(data) = &v.to_userdata_cast<QObjectWrapper>()->get_object();
-	break;
 #if QT_VERSION < 0x050000
-      case QMetaType::QWidgetStar: {
-	if (v.is_nil())
-	  {
-	    *reinterpret_cast<QWidget**>(data) = 0;
-	    break;
-	  }
-	QObject *obj = &v.to_userdata_cast<QObjectWrapper>()->get_object();
-	QWidget *w = dynamic_cast<QWidget*>(obj);
-	if (obj && !w)
-	  QTLUA_THROW(QtLua::MetaType, "Can not convert a non-QObject lua value to a QWidget.");
-	else
-	  *reinterpret_cast<QWidget**>(data) = w;
-	break;
-      }
+      case QMetaType::QWidgetStar:
 #endif
-      case QMetaType::QSize: {
-	QSize *size = reinterpret_cast<QSize*>(data);
-	size->setWidth(v.at(1).to_number());
-	size->setHeight(v.at(2).to_number());
-	break;
-      }
-      case QMetaType::QSizeF: {
-	QSizeF *size = reinterpret_cast<QSizeF*>(data);
-	size->setWidth(v.at(1).to_number());
-	size->setHeight(v.at(2).to_number());
-	break;
-      }
-      case QMetaType::QSizePolicy: {
-	QSizePolicy *sp = reinterpret_cast<QSizePolicy*>(data);
-	sp->setHorizontalStretch(v.at(1).to_number());
-	sp->setVerticalStretch(v.at(2).to_number());
-	sp->setHorizontalPolicy((QSizePolicy::Policy)v.at(3).to_integer());
-	sp->setVerticalPolicy((QSizePolicy::Policy)v.at(4).to_integer());
-	break;
-      }
-      case QMetaType::QRect: {
-	QRect *rect = reinterpret_cast<QRect*>(data);
-	rect->setX(v.at(1).to_number());
-	rect->setY(v.at(2).to_number());
-	rect->setWidth(v.at(3).to_number());
-	rect->setHeight(v.at(4).to_number());
-	break;
-      }
-      case QMetaType::QRectF: {
-	QRectF *rect = reinterpret_cast<QRectF*>(data);
-	rect->setX(v.at(1).to_number());
-	rect->setY(v.at(2).to_number());
-	rect->setWidth(v.at(3).to_number());
-	rect->setHeight(v.at(4).to_number());
-	break;
-      }
-      case QMetaType::QPoint: {
-	QPoint *point = reinterpret_cast<QPoint*>(data);
-	point->setX(v.at(1).to_number());
-	point->setY(v.at(2).to_number());
-	break;
-      }
-      case QMetaType::QPointF: {
-	QPointF *point = reinterpret_cast<QPointF*>(data);
-	point->setX(v.at(1).to_number());
-	point->setY(v.at(2).to_number());
-	break;
-      }
-      case QMetaType::QIcon: {
-	QIcon *icon = reinterpret_cast<QIcon*>(data);
-	*icon = QIcon(v.to_string());
-	break;
-      }
-      case QMetaType::QColor: {
-	QColor *color = reinterpret_cast<QColor*>(data);
-	*color = QColor(v.at(1).to_integer(), v.at(2).to_integer(), v.at(3).to_integer());
-	break;
-      }
-      default: {
-
-	if (!QMetaType::isRegistered(type))
-	  QTLUA_THROW(QtLua::MetaType, "Unable to convert from lua type `%' to the non-registered Qt type handle `%'.",
-		      .arg(v.type_name_u()).arg(type));
-
+	return t == Value::TUserData || t == Value::TNil;
+      case QMetaType::QStringList:
+      case QMetaType::QVariantList:
+      case QMetaType::QVariantMap:
+      case QMetaType::QVariantHash:
+      case QMetaType::QSizePolicy:
+	return t == Value::TTable;
+      case QMetaType::QSize:
+      case QMetaType::QSizeF:
+      case QMetaType::QRect:
+      case QMetaType::QRectF:
+      case QMetaType::QPoint:
+      case QMetaType::QPointF:
+      case QMetaType::QColor:
+	return t == Value::TUserData || t == Value::TTable;
+      case 0:
+	return false;
+      default:
 	if (type == ud_ref_type)
-	  {
-	    *reinterpret_cast<Ref<UserData>*>(data) = v.to_userdata();
-	    break;
-	  }
-
-	metatype_map_t::const_iterator i = types_map.find(type);
+	  return t == Value::TUserData || t == Value::TNil;
 
-	if (i != types_map.end() && i.value()->lua2qt(data, v))
-	  break;
+	// user defined conversion may handle any lua type
+	const Converter *c = get_converter(type);
+	return c && c->_mt;
       }
+  }
 
-      case 0:
-	QTLUA_THROW(QtLua::MetaType, "Unsupported conversion from lua type `%' to Qt type `%'.",
-		    .arg(v.type_name_u()).arg(QMetaType::typeName(type)));
-      }
+  void QMetaValue::raw_set_object(int type, void *data, const Value &v)
+  {
+    const Converter *c = get_converter(type);
+
+    if (!c && !QMetaType::isRegistered(type))
+      QTLUA_THROW(QtLua::MetaType, "Unable to convert from lua type `%' to the non-registered Qt type handle `%'.",
+		  .arg(v.type_name_u()).arg(type));
 
+    if (!c || !c->_lua2qt || !c->_lua2qt(data, v, c->_mt))
+      QTLUA_THROW(QtLua::MetaType, "Unsupported conversion from lua type `%' to Qt type `%'.",
+		  .arg(v.type_name_u()).arg(QMetaType::typeName(type)));
   }
 
 }
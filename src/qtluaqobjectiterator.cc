@@ -149,5 +149,39 @@ namespace QtLua {
     return ValueRef(Value(), Value());
   }
 
+  int QObjectIterator::push_next(lua_State *st)
+  {
+    if (!more())
+      return 0;
+
+    switch (_cur)
+      {
+      case CurChildren:
+	if (!_ls || !_qow->_obj)
+	  {
+	    push(st, _ls, Value(_ls));
+	    push(st, _ls, Value(_ls));
+	  }
+	else
+	  {
+	    QObject *child = _qow->_obj->children().at(_child_id);
+	    push(st, _ls, QObjectWrapper::qobject_name(*child));
+	    push(st, _ls, QObjectWrapper::get_wrapper(_ls, child));
+	  }
+	break;
+
+      case CurMember:
+	push(st, _ls, _it.key());
+	push(st, _ls, _it.value());
+	break;
+
+      default:
+	std::abort();
+      }
+
+    next();
+    return 2;
+  }
+
 }
 
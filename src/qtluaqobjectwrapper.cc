@@ -18,28 +18,41 @@
 
 */
 
+#include <cstdlib>
+#include <algorithm>
+
 #include <QDebug>
 #include <QObject>
 #include <QMetaObject>
 #include <QWidget>
+#include <QTimerEvent>
 
 #include <internal/QObjectWrapper>
 
 #include <internal/QMetaValue>
 #include <internal/Method>
+#include <internal/Property>
 #include <internal/MetaCache>
 #include <internal/QObjectIterator>
 
+extern "C" {
+#include <lua.h>
+}
+
 #define assert_do(x) { bool res_ = (x); assert (((void)#x, res_)); }
 
 namespace QtLua {
 
-  static const int destroyindex = QObject::staticMetaObject.indexOfSignal("destroyed()");
+  static const int destroyindex = QObject::staticMetaObject.indexOfSignal("destroyed(QObject*)");
+  static const int hubindex = State::staticMetaObject.indexOfSlot("qobject_destroyed(QObject*)");
+  /** number of released lua slot ids kept before reuse */
+  static const int lua_slot_reuse_delay = 64;
 
   QObjectWrapper::QObjectWrapper(State *ls, QObject *obj)
     : _ls(ls),
       _obj(obj),
-      _lua_next_slot(1),
+      _receiver(0),
+      _lua_next_slot(0),
       _reparent(false),
       _delete(obj && obj->parent())
   {
@@ -49,7 +62,8 @@ namespace QtLua {
 
     if (_obj)
       {
-	assert_do(QMetaObject::connect(obj, destroyindex, this, metaObject()->methodCount() + 0));
+	// destruction in an other thread is reported in the State thread
+	assert_do(QMetaObject::connect(obj, destroyindex, ls, hubindex));
 
 	ls->_whash.insert(obj, this);
 	// increment reference count since we are bound to a qobject
@@ -91,7 +105,9 @@ namespace QtLua {
 #ifdef QTLUA_QOBJECTWRAPPER_DEBUG
     qDebug() << "wrapped object has been destroyed" << _obj;
 #endif
-    assert(_obj = sender());
+
+    // connections are dropped along with the object
+    lua_slots_clear();
 
     assert_do(_ls->_whash.remove(_obj));
     _obj = 0;
@@ -108,10 +124,10 @@ namespace QtLua {
       {
 	assert_do(_ls->_whash.remove(_obj));
 
-	assert_do(QMetaObject::disconnect(_obj, destroyindex, this, metaObject()->methodCount() + 0));
-
 	_lua_disconnect_all();
 
+	assert_do(QMetaObject::disconnect(_obj, destroyindex, _ls, hubindex));
+
 	if (!_obj->parent() && _delete)
 	  {
 #ifdef QTLUA_QOBJECTWRAPPER_DEBUG
@@ -120,6 +136,8 @@ namespace QtLua {
 	    delete _obj;
 	  }
       }
+
+    delete _receiver;
   }
 
   void QObjectWrapper::ref_single()
@@ -132,51 +150,222 @@ namespace QtLua {
       _drop();
   }
 
-  int QObjectWrapper::qt_metacall(QMetaObject::Call c, int id, void **qt_args)
+  int QObjectWrapper::Receiver::qt_metacall(QMetaObject::Call c, int id, void **qt_args)
   {
     id = QObject::qt_metacall(c, id, qt_args);
 
     if (id < 0 || c != QMetaObject::InvokeMetaMethod)
       return id;
 
-    if (id == 0)
-      {
-	// slot 0 is reserved for object.destroyed() signal
-	obj_destroyed();
-	return -1;
-      }
+    // a queued call may still be pending for a slot which has been
+    // disconnected, or for an object which is not wrapped anymore
+    if (sender() != _qow._obj)
+      return -1;
+
+#if QT_VERSION >= 0x040800
+    _qow.lua_slot_call(id, senderSignalIndex(), qt_args);
+#else
+    _qow.lua_slot_call(id, -1, qt_args);
+#endif
+
+    return -1;
+  }
+
+  void QObjectWrapper::Receiver::timerEvent(QTimerEvent *event)
+  {
+    _qow.lua_slot_timer(event);
+  }
 
+  void QObjectWrapper::lua_slot_call(int id, int sigindex, void **qt_args)
+  {
     if (!_obj)
-      return -1;
+      return;
 
+    // ignore stale calls which do not match a current connection
     lua_slots_hash_t::iterator i = _lua_slots.find(id);
-    assert(i != _lua_slots.end());
+    if (i == _lua_slots.end() || (sigindex >= 0 && i.value()._sigindex != sigindex))
+      return;
+
+    LuaSlot &slot = i.value();
+    int argc = slot._types.size();
+
+    if (slot._mode != ValueBase::ConnectDirect)
+      {
+	Value::List lua_args;
+
+	lua_args.push_back(Value(_ls, QObjectWrapper::get_wrapper(_ls, _obj)));
+
+	for (int j = 0; j < argc; j++)
+	  lua_args.push_back(QMetaValue::raw_get_object(_ls, slot._types[j], qt_args[j + 1]));
+
+	lua_slot_queue(id, slot, lua_args);
+	return;
+      }
+
+    if (slot._function)
+      {
+	// push function and arguments directly on lua stack
+	lua_State *lst = _ls->_lst;
+	int oldtop = lua_gettop(lst);
+
+	try {
+	  if (!lua_checkstack(lst, argc + 2))
+	    QTLUA_THROW(QtLua::QObjectWrapper, "Unable to extend the lua stack to handle % arguments.",
+			.arg(argc + 1));
+
+	  slot._value.push_value(lst);
+	  push_ud(lst);
+
+	  for (int j = 0; j < argc; j++)
+	    QMetaValue::raw_push_object(_ls, lst, slot._types[j], qt_args[j + 1]);
+
+	} catch (const String &err) {
+	  lua_settop(lst, oldtop);
+	  qDebug() << "Error executing lua slot:" << err;
+	  return;
+	}
+
+	if (lua_pcall(lst, argc + 1, 0, 0))
+	  {
+	    String err(lua_tostring(lst, -1));
+	    lua_settop(lst, oldtop);
+	    qDebug() << "Error executing lua slot:" << err;
+	  }
+
+	return;
+      }
 
     Value::List lua_args;
 
-    // first arg is sender object
-    assert(_obj == sender());
     lua_args.push_back(Value(_ls, QObjectWrapper::get_wrapper(_ls, _obj)));
 
     // push more args from parameter type informations
-    QMetaMethod mm = _obj->metaObject()->method(i.value()._sigindex);
+    for (int j = 0; j < argc; j++)
+      lua_args.push_back(QMetaValue::raw_get_object(_ls, slot._types[j], qt_args[j + 1]));
 
-    foreach(const QByteArray &pt, mm.parameterTypes())
-      {
-	qt_args++;
-	lua_args.push_back(QMetaValue::raw_get_object(_ls, QMetaType::type(pt.constData()), *qt_args));
-      }
+    try {
+      Value value(slot._value);
+      value.call(lua_args);
+    } catch (const String &err) {
+      qDebug() << "Error executing lua slot:" << err;
+    }
+  }
+
+  void QObjectWrapper::lua_slot_queue(int slot_id, LuaSlot &slot, const Value::List &lua_args)
+  {
+    if (slot._mode == ValueBase::ConnectLatest)
+      slot._pending.clear();
+    slot._pending.push_back(lua_args);
+
+    if (slot._timer)
+      return;
+
+    // schedule delivery on next event loop pass or when rate limit allows
+    int delay = 0;
+    if (slot._interval && slot._last.isValid())
+      delay = std::max(0, slot._interval - (int)slot._last.elapsed());
+
+    slot._timer = _receiver->startTimer(delay);
+    _lua_timers.insert(slot._timer, slot_id);
+  }
+
+  void QObjectWrapper::lua_slot_cancel(LuaSlot &slot)
+  {
+    if (!slot._timer)
+      return;
+
+    _receiver->killTimer(slot._timer);
+    _lua_timers.remove(slot._timer);
+    slot._timer = 0;
+    slot._pending.clear();
+  }
+
+  void QObjectWrapper::lua_slot_timer(QTimerEvent *event)
+  {
+    int timer = event->timerId();
+    _receiver->killTimer(timer);
+
+    QHash<int, int>::iterator t = _lua_timers.find(timer);
+    if (t == _lua_timers.end())
+      return;
+
+    lua_slots_hash_t::iterator i = _lua_slots.find(t.value());
+    _lua_timers.erase(t);
+    assert(i != _lua_slots.end());
+
+    LuaSlot &slot = i.value();
+    QList<Value::List> pending(slot._pending);
+    // slot may be disconnected during call
+    Value value(slot._value);
+    ValueBase::ConnectMode mode = slot._mode;
+
+    slot._pending.clear();
+    slot._timer = 0;
+    slot._last.start();
+
+    if (pending.isEmpty())
+      return;
 
     try {
-      i.value()._value.call(lua_args);
+      switch (mode)
+	{
+	case ValueBase::ConnectLatest:
+	  value.call(pending.last());
+	  break;
+
+	case ValueBase::ConnectBatch: {
+	  Value::List lua_args;
+	  lua_args.push_back(pending.first().first());
+
+	  Value batch(Value::new_table(_ls));
+
+	  for (int j = 0; j < pending.size(); j++)
+	    {
+	      const Value::List &args = pending.at(j);
+	      Value tuple(Value::new_table(_ls));
+
+	      for (int k = 1; k < args.size(); k++)
+		tuple[k] = args.at(k);
+
+	      batch[j + 1] = tuple;
+	    }
+
+	  lua_args.push_back(batch);
+	  value.call(lua_args);
+	  break;
+	}
+
+	default:
+	  std::abort();
+	}
     } catch (const String &err) {
       qDebug() << "Error executing lua slot:" << err;
     }
+  }
 
-    return -1;
+  const void * QObjectWrapper::lua_value_ptr(const Value &value)
+  {
+    lua_State *lst = _ls->_lst;
+
+    value.push_value(lst);
+    const void *ptr = lua_topointer(lst, -1);
+
+    // userdata values are compared using wrapped object identity
+    if (lua_type(lst, -1) == Value::TUserData)
+      {
+	try {
+	  ptr = UserData::get_ud(lst, -1).ptr();
+	} catch (const String &e) {
+	}
+      }
+
+    lua_pop(lst, 1);
+
+    return ptr;
   }
 
-  void QObjectWrapper::_lua_connect(int sigindex, const Value &value)
+  void QObjectWrapper::_lua_connect(int sigindex, const Value &value,
+				    ValueBase::ConnectMode mode, int max_rate)
   {
     get_object();
 
@@ -184,15 +373,30 @@ namespace QtLua {
       {
       case Value::TUserData:
       case Value::TFunction: {
-	int slot_id;
+	if (!_receiver)
+	  _receiver = new Receiver(*this);
+
+	// released ids are reused in release order and only once
+	// enough of them are available, so that a queued call of a
+	// disconnected slot is unlikely to reach a new connection
+	bool reuse = _lua_free_slots.size() > lua_slot_reuse_delay;
+	int slot_id = reuse ? _lua_free_slots.head() : _lua_next_slot;
+
+	// signals emitted from other threads are queued by Qt and
+	// delivered in the thread of the receiver
+	if (QMetaObject::connect(_obj, sigindex, _receiver, _receiver->metaObject()->methodCount() + slot_id))
+	  {
+	    if (reuse)
+	      _lua_free_slots.dequeue();
+	    else
+	      _lua_next_slot++;
 
-	do {
-	  slot_id = _lua_next_slot++;
-	} while (_lua_slots.contains(slot_id));
+	    LuaSlot slot(value, sigindex, _obj->metaObject()->method(sigindex), mode, max_rate);
+	    slot._ptr = lua_value_ptr(value);
 
-	if (QMetaObject::connect(_obj, sigindex, this, metaObject()->methodCount() + slot_id))
-	  {
-	    _lua_slots.insert(slot_id, LuaSlot(value, sigindex));
+	    _lua_slots.insert(slot_id, slot);
+	    _lua_sig_slots.insert(sigindex, slot_id);
+	    _lua_ptr_slots.insert(slot._ptr, slot_id);
 	    return;
 	  }
 
@@ -205,25 +409,41 @@ namespace QtLua {
       }
   }
 
+  void QObjectWrapper::lua_slot_remove(int slot_id)
+  {
+    lua_slots_hash_t::iterator i = _lua_slots.find(slot_id);
+    assert(i != _lua_slots.end());
+
+    LuaSlot &slot = i.value();
+    lua_slot_cancel(slot);
+
+    assert_do(QMetaObject::disconnect(_obj, slot._sigindex, _receiver,
+				      _receiver->metaObject()->methodCount() + slot_id));
+
+    _lua_sig_slots.remove(slot._sigindex, slot_id);
+    _lua_ptr_slots.remove(slot._ptr, slot_id);
+    _lua_slots.erase(i);
+    _lua_free_slots.enqueue(slot_id);
+  }
+
   bool QObjectWrapper::_lua_disconnect(int sigindex, const Value &value)
   {
     if (!_obj)
       return false;
 
-    lua_slots_hash_t::iterator i;
+    const void *ptr = lua_value_ptr(value);
 
-    for (i = _lua_slots.begin(); i != _lua_slots.end(); )
+    for (lua_ptr_slots_t::const_iterator i = _lua_ptr_slots.constFind(ptr);
+	 i != _lua_ptr_slots.constEnd() && i.key() == ptr; ++i)
       {
-	if (i.value()._sigindex == sigindex && value == i.value()._value)
+	// compare in place, do not copy the slot
+	lua_slots_hash_t::const_iterator s = _lua_slots.constFind(i.value());
+
+	if (s != _lua_slots.constEnd() && s.value()._sigindex == sigindex)
 	  {
-	    bool ok = QMetaObject::disconnect(_obj, sigindex, this, metaObject()->methodCount() + i.key());
-	    assert(ok);
-	    _lua_next_slot = std::min(_lua_next_slot, i.key());
-	    i = _lua_slots.erase(i);
+	    lua_slot_remove(i.value());
 	    return true;
 	  }
-	else
-	  ++i;
       }
 
     return false;
@@ -234,20 +454,8 @@ namespace QtLua {
     if (!_obj)
       return;
 
-    lua_slots_hash_t::iterator i;
-
-    for (i = _lua_slots.begin(); i != _lua_slots.end(); )
-      {
-	if (i.value()._sigindex == sigindex)
-	  {
-	    bool ok = QMetaObject::disconnect(_obj, sigindex, this, metaObject()->methodCount() + i.key());
-	    assert(ok);
-	    _lua_next_slot = std::min(_lua_next_slot, i.key());
-	    i = _lua_slots.erase(i);
-	  }
-	else
-	  ++i;
-      }
+    foreach(int slot_id, _lua_sig_slots.values(sigindex))
+      lua_slot_remove(slot_id);
   }
 
   void QObjectWrapper::_lua_disconnect_all()
@@ -255,16 +463,26 @@ namespace QtLua {
     if (!_obj)
       return;
 
-    lua_slots_hash_t::iterator i;
+    if (_lua_slots.isEmpty())
+      return;
+
+    // drop all connections to the receiver in a single pass
+    QObject::disconnect(_obj, 0, _receiver, 0);
+
+    lua_slots_clear();
+  }
 
-    for (i = _lua_slots.begin(); i != _lua_slots.end(); )
+  void QObjectWrapper::lua_slots_clear()
+  {
+    for (lua_slots_hash_t::iterator i = _lua_slots.begin(); i != _lua_slots.end(); ++i)
       {
-	bool ok = QMetaObject::disconnect(_obj, i.value()._sigindex, this, metaObject()->methodCount() + i.key());
-	assert(ok);
-	++i;
+	lua_slot_cancel(i.value());
+	_lua_free_slots.enqueue(i.key());
       }
+
     _lua_slots.clear();
-    _lua_next_slot = 1;
+    _lua_sig_slots.clear();
+    _lua_ptr_slots.clear();
   }
 
   QObject * QObjectWrapper::get_child(QObject &obj, const String &name)
@@ -290,6 +508,100 @@ namespace QtLua {
     return m.valid() ? m->access(*this) : Value(ls);
   }
 
+  /** Get name of a property from the lua string at given stack index */
+  static String property_name(lua_State *st, int index)
+  {
+    if (lua_type(st, index) != LUA_TSTRING)
+      QTLUA_THROW(QtLua::QObjectWrapper, "Can not use a `lua::%' value as a property name.",
+		  .arg(lua_typename(st, lua_type(st, index))));
+
+    size_t len;
+    const char *s = lua_tolstring(st, index, &len);
+    return String(s, len);
+  }
+
+  static const Member::ptr & property_lookup(const property_cache_t &pt, const String &name)
+  {
+    property_cache_t::const_iterator i = pt.constFind(name);
+
+    if (i == pt.constEnd())
+      QTLUA_THROW(QtLua::QObjectWrapper, "Unknow QObject property `%'.", .arg(name));
+
+    return i.value();
+  }
+
+  Value QObjectWrapper::get_properties(State *ls, const Value &names)
+  {
+    const property_cache_t &pt = MetaCache::get_meta(get_object()).get_property_table();
+    lua_State *lst = ls->get_lua_state();
+    int top = lua_gettop(lst);
+    Value result(Value::new_table(ls));
+
+    if (!lua_checkstack(lst, 5))
+      QTLUA_THROW(QtLua::QObjectWrapper, "Unable to extend the lua stack.");
+
+    names.push_value(lst);
+    result.push_value(lst);
+
+    try {
+      if (lua_type(lst, top + 1) != LUA_TTABLE)
+	QTLUA_THROW(QtLua::QObjectWrapper, "Can not read property names from a `lua::%' value.",
+		    .arg(lua_typename(lst, lua_type(lst, top + 1))));
+
+      // walk the names array in place, properties come from the
+      // flattened table of the class
+      int len = QMetaValue::raw_len(lst, top + 1);
+
+      for (int i = 1; i <= len; i++)
+	{
+	  lua_rawgeti(lst, top + 1, i);
+	  const Member::ptr &m = property_lookup(pt, property_name(lst, -1));
+
+	  m->access(*this).push_value(lst);
+	  lua_rawset(lst, top + 2);
+	}
+    } catch (...) {
+      lua_settop(lst, top);
+      throw;
+    }
+
+    lua_settop(lst, top);
+    return result;
+  }
+
+  void QObjectWrapper::set_properties(const Value &table)
+  {
+    const property_cache_t &pt = MetaCache::get_meta(get_object()).get_property_table();
+    lua_State *lst = _ls->get_lua_state();
+    int top = lua_gettop(lst);
+
+    if (!lua_checkstack(lst, 4))
+      QTLUA_THROW(QtLua::QObjectWrapper, "Unable to extend the lua stack.");
+
+    table.push_value(lst);
+
+    try {
+      if (lua_type(lst, top + 1) != LUA_TTABLE)
+	QTLUA_THROW(QtLua::QObjectWrapper, "Can not read property values from a `lua::%' value.",
+		    .arg(lua_typename(lst, lua_type(lst, top + 1))));
+
+      lua_pushnil(lst);
+
+      while (lua_next(lst, top + 1))
+	{
+	  const Member::ptr &m = property_lookup(pt, property_name(lst, -2));
+
+	  m->assign(*this, Value(-1, _ls));
+	  lua_pop(lst, 1);
+	}
+    } catch (...) {
+      lua_settop(lst, top);
+      throw;
+    }
+
+    lua_settop(lst, top);
+  }
+
   void QObjectWrapper::reparent(QObject *parent)
   {
     assert(_obj);
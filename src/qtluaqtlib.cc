@@ -67,6 +67,7 @@
 #include <QtLua/TableGridModel>
 #include <QtLua/TableTreeModel>
 #include <QtLua/LuaModel>
+#include <QtLua/NumArray>
 
 #include <internal/Method>
 #include <internal/MetaCache>
@@ -115,9 +116,10 @@ namespace QtLua {
 
   QTLUA_FUNCTION(connect, "Connect a Qt signal to a Qt slot or lua function.",
 		 "usage: qt.connect(qobjectwrapper, \"qt_signal_signature()\", qobjectwrapper, \"qt_slot_signature()\")\n"
-		 "       qt.connect(qobjectwrapper, \"qt_signal_signature()\", lua_function)\n")
+		 "       qt.connect(qobjectwrapper, \"qt_signal_signature()\", lua_function)\n"
+		 "       qt.connect(qobjectwrapper, \"qt_signal_signature()\", lua_function, \"latest\"|\"batch\", [ max_rate ])\n")
   {
-    meta_call_check_args(args, 3, 4, Value::TUserData, Value::TString, Value::TNone, Value::TString);
+    meta_call_check_args(args, 3, 5, Value::TUserData, Value::TString, Value::TNone, Value::TString, Value::TNumber);
 
     QObjectWrapper::ptr sigqow = args[0].to_userdata_cast<QObjectWrapper>();
 
@@ -128,18 +130,36 @@ namespace QtLua {
     if (sigindex < 0)
       QTLUA_THROW(qt.connect, "No such signal `%'.", .arg(signame));
 
-    switch (args.size())
+    // a wrapper and a slot signature select a Qt slot, with 3
+    // arguments a wrapper is connected as a callable lua value
+    QObjectWrapper::ptr sloqow = args.size() == 4 && args[2].type() == Value::TUserData
+      ? args[2].to_userdata().dynamiccast<QObjectWrapper>() : QObjectWrapper::ptr();
+
+    if (!sloqow.valid())
       {
-      case 3: {
 	// connect qt signal to lua function
-	sigqow->_lua_connect(sigindex, args[2]);
-	break;
-      }
+	ValueBase::ConnectMode mode = ValueBase::ConnectDirect;
 
-      case 4: {
+	if (args.size() > 3)
+	  {
+	    String m(args[3].to_string());
+
+	    if (m == "latest")
+	      mode = ValueBase::ConnectLatest;
+	    else if (m == "batch")
+	      mode = ValueBase::ConnectBatch;
+	    else if (m != "direct")
+	      QTLUA_THROW(qt.connect, "Bad connection mode `%'.", .arg(m));
+	  }
+
+	sigqow->_lua_connect(sigindex, args[2], mode,
+			     args.size() > 4 ? args[4].to_integer() : 0);
+      }
+    else
+      {
 	// connect qt signal to qt slot
 	String slotname = args[3].to_string();
-	QObject &sloobj = args[2].to_userdata_cast<QObjectWrapper>()->get_object();	
+	QObject &sloobj = sloqow->get_object();
 
 	int slotindex = sloobj.metaObject()->indexOfSlot(slotname.constData());
 	if (slotindex < 0)
@@ -152,7 +172,6 @@ namespace QtLua {
 	if (!QMetaObject::connect(&sigobj, sigindex, &sloobj, slotindex))
 	  QTLUA_THROW(qt.connect, "Unable to connect signal to slot.");
       }
-      }
 
     return Value::List();
   }
@@ -240,6 +259,28 @@ namespace QtLua {
   }
 
 
+  QTLUA_FUNCTION(props_get, "Read multiple properties of a QObject.",
+		 "usage: qt.props.get(qobjectwrapper, { \"property_name\", ... })\n")
+  {
+    meta_call_check_args(args, 2, 2, Value::TUserData, Value::TTable);
+
+    QObjectWrapper::ptr qow = args[0].to_userdata_cast<QObjectWrapper>();
+
+    return qow->get_properties(ls, args[1]);
+  }
+
+  QTLUA_FUNCTION(props_set, "Write multiple properties of a QObject.",
+		 "usage: qt.props.set(qobjectwrapper, { property_name = value, ... })\n")
+  {
+    meta_call_check_args(args, 2, 2, Value::TUserData, Value::TTable);
+
+    QObjectWrapper::ptr qow = args[0].to_userdata_cast<QObjectWrapper>();
+    qow->set_properties(args[1]);
+
+    return Value::List();
+  }
+
+
   QTLUA_FUNCTION(new_qobject, "Dynamically create a new QObject.",
 		 "usage: qt.new_qobject( qt.meta.QClassName, [ Constructor arguments ] )\n")
   {
@@ -249,6 +290,25 @@ namespace QtLua {
   }
 
 
+  QTLUA_FUNCTION(new_numarray, "Create a new typed numeric array.",
+		 "usage: qt.new_numarray( \"float\"|\"double\"|\"int32\"|\"int64\", size | { value, ... } )\n")
+  {
+    String type = get_arg<String>(args, 0);
+    const Value &init = get_arg<const Value &>(args, 1);
+
+    if (type == "float")
+      return Value(ls, NumArray<float>::from_value(init));
+    if (type == "double")
+      return Value(ls, NumArray<double>::from_value(init));
+    if (type == "int32")
+      return Value(ls, NumArray<qint32>::from_value(init));
+    if (type == "int64")
+      return Value(ls, NumArray<qint64>::from_value(init));
+
+    QTLUA_THROW(qt.new_numarray, "Unsupported numeric array element type `%'.", .arg(type));
+  }
+
+
   ////////////////////////////////////////////////// ui
 
 
@@ -1063,6 +1123,9 @@ namespace QtLua {
     QTLUA_FUNCTION_REGISTER(ls, "qt.", connect_slots_by_name );
     QTLUA_FUNCTION_REGISTER(ls, "qt.", disconnect            );
     QTLUA_FUNCTION_REGISTER(ls, "qt.", meta_type             );
+    QTLUA_FUNCTION_REGISTER(ls, "qt.", new_numarray          );
+    QTLUA_FUNCTION_REGISTER2(ls, "qt.props.get", props_get   );
+    QTLUA_FUNCTION_REGISTER2(ls, "qt.props.set", props_set   );
 
     QTLUA_FUNCTION_REGISTER(ls, "qt.", tr                    );
     QTLUA_FUNCTION_REGISTER(ls, "qt.", translator            );
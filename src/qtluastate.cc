@@ -48,6 +48,7 @@ namespace QtLua {
 char State::_key_threads;
 char State::_key_item_metatable;
 char State::_key_this;
+char State::_key_next;
 
   /* save current thread lua_State and set new lua_State */
 #define QTLUA_SWITCH_THREAD(this_, st)	     \
@@ -68,23 +69,22 @@ int State::lua_cmd_iterator(lua_State *st)
   QTLUA_SWITCH_THREAD(this_, st);
 
   try {
-    Iterator::ptr	i = Value(1, this_).to_userdata_cast<Iterator>();
+    Iterator::ptr	i = UserData::get_ud(st, 1).dynamiccast<Iterator>();
 
-    if (i->more())
-      {
-	i->get_key().push_value(st);
-	i->get_value().push_value(st);
-	i->next();
-	QTLUA_RESTORE_THREAD(this_);
-	return 2;
-      }
-    else
+    if (!i.valid())
+      QTLUA_THROW(QtLua::State, "Bad iterator object passed to the iterator function.");
+
+    int n = i->push_next(st);
+
+    if (!n)
       {
 	lua_pushnil(st);
-	QTLUA_RESTORE_THREAD(this_);
-	return 1;
+	n = 1;
       }
 
+    QTLUA_RESTORE_THREAD(this_);
+    return n;
+
   } catch (String &e) {
     QTLUA_RESTORE_THREAD(this_);
     luaL_error(st, "%s", e.constData());
@@ -95,6 +95,25 @@ int State::lua_cmd_iterator(lua_State *st)
 
 int State::lua_cmd_each(lua_State *st)
 {
+  // plain tables are iterated by the lua vm using the native next function
+  if (lua_type(st, 1) == LUA_TTABLE)
+    {
+      if (!lua_getmetatable(st, 1))
+	{
+	  // base library next function saved when the library was opened
+	  lua_pushlightuserdata(st, &_key_next);
+	  lua_rawget(st, LUA_REGISTRYINDEX);
+
+	  if (lua_iscfunction(st, -1))
+	    {
+	      lua_pushvalue(st, 1);
+	      lua_pushnil(st);
+	      return 3;
+	    }
+	}
+      lua_pop(st, 1);
+    }
+
   State               *this_ = get_this(st);
   QTLUA_SWITCH_THREAD(this_, st);
 
@@ -394,17 +413,10 @@ int State::lua_meta_item_call(lua_State *st)
 
     bool oy = this_->_yield_on_return;
     this_->_yield_on_return = false;
-    args = ud->meta_call(this_, args);
+    ud->meta_call_push(this_, st, args);
     yield = this_->_yield_on_return;
     this_->_yield_on_return = oy;
 
-    if (!lua_checkstack(st, args.size()))
-      QTLUA_THROW(QtLua::State, "Unable to extend the lua stack to handle % return values",
-		  .arg(args.size()));
-
-    foreach(const Value &v, args)
-      v.push_value(st);
-
   } catch (String &e) {
     QTLUA_RESTORE_THREAD(this_);
     luaL_error(st, "%s", e.constData());
@@ -809,6 +821,7 @@ State::State()
 #endif
 
   _debug_output = false;
+  _bytearray_blob = false;
   _yield_on_return = false;
 }
 
@@ -828,6 +841,14 @@ State::~State()
     i.value()->_drop();
 }
 
+void State::qobject_destroyed(QObject *obj)
+{
+  wrapper_hash_t::iterator i = _whash.find(obj);
+
+  if (i != _whash.end())
+    i.value()->obj_destroyed();
+}
+
 Value State::eval_expr(bool use_lua, const String &expr)
 {
   // Use lua to transform user input to lua value
@@ -983,6 +1004,51 @@ State * State::get_this(lua_State *st)
   lua_pop(st, 1);
 #endif
 
+#if LUA_VERSION_NUM < 502
+/** Lua 5.1 pairs replacement which honors the @tt __pairs metamethod
+    of packed values, forward to the base library pairs otherwise. */
+static int lua_pairs_wrapper(lua_State *st)
+{
+  if (luaL_getmetafield(st, 1, "__pairs"))
+    {
+      lua_pushvalue(st, 1);
+      lua_call(st, 1, 3);
+      return 3;
+    }
+
+  lua_pushvalue(st, lua_upvalueindex(1));
+  lua_insert(st, 1);
+  lua_call(st, lua_gettop(st) - 1, LUA_MULTRET);
+  return lua_gettop(st);
+}
+#endif
+
+void State::open_base(lua_State *st)
+{
+  QTLUA_LUA_CALL(st, luaopen_base, "_G");
+
+  // keep the native next function, global may be replaced by scripts
+  lua_pushlightuserdata(st, &_key_next);
+#if LUA_VERSION_NUM < 502
+  lua_pushstring(st, "next");
+  lua_rawget(st, LUA_GLOBALSINDEX);
+#else
+  lua_pushglobaltable(st);
+  lua_pushstring(st, "next");
+  lua_rawget(st, -2);
+  lua_remove(st, -2);
+#endif
+  lua_rawset(st, LUA_REGISTRYINDEX);
+
+#if LUA_VERSION_NUM < 502
+  lua_pushstring(st, "pairs");
+  lua_pushstring(st, "pairs");
+  lua_rawget(st, LUA_GLOBALSINDEX);
+  lua_pushcclosure(st, lua_pairs_wrapper, 1);
+  lua_rawset(st, LUA_GLOBALSINDEX);
+#endif
+}
+
 bool State::openlib(Library lib)
 {
   switch (lib)
@@ -993,7 +1059,7 @@ bool State::openlib(Library lib)
       return true;
 #endif
     case BaseLib:
-      QTLUA_LUA_CALL(_lst, luaopen_base, "_G");
+      open_base(_lst);
       return true;
 #ifdef HAVE_LUA_PACKAGELIB
     case PackageLib:
@@ -1049,7 +1115,7 @@ bool State::openlib(Library lib)
 #ifdef HAVE_LUA_PACKAGELIB
       QTLUA_LUA_CALL(_lst, luaopen_package, "package");
 #endif
-      QTLUA_LUA_CALL(_lst, luaopen_base, "_G");
+      open_base(_lst);
       QTLUA_LUA_CALL(_lst, luaopen_string, "string");
       QTLUA_LUA_CALL(_lst, luaopen_table, "table");
       QTLUA_LUA_CALL(_lst, luaopen_math, "math");
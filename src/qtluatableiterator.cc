@@ -133,5 +133,16 @@ ValueRef TableIterator::get_value_ref()
   return ref;
 }
 
+int TableIterator::push_next(lua_State *st)
+{
+  if (!more())
+    return 0;
+
+  _key.push_value(st);
+  _value.push_value(st);
+  fetch();
+  return 2;
+}
+
 }
 
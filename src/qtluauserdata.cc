@@ -134,12 +134,35 @@ bool UserData::meta_contains(State *ls, const Value &key)
   }
 }
 
+bool UserData::meta_try_index(State *ls, const Value &key, Value &value)
+{
+  if (!meta_contains(ls, key))
+    return false;
+
+  value = meta_index(ls, key);
+  return true;
+}
+
 Value::List UserData::meta_call(State *ls, const Value::List &args) 
 {
   QTLUA_THROW(QtLua::UserData, "The call operation is not handled by the `%' class.",
 	      .arg(get_type_name()));
 };
 
+int UserData::meta_call_push(State *ls, lua_State *st, const Value::List &args)
+{
+  Value::List res = meta_call(ls, args);
+
+  if (!lua_checkstack(st, res.size()))
+    QTLUA_THROW(QtLua::UserData, "Unable to extend the lua stack to handle % return values",
+		.arg(res.size()));
+
+  foreach(const Value &v, res)
+    v.push_value(st);
+
+  return res.size();
+}
+
 Ref<Iterator> UserData::new_iterator(State *ls)
 {
   QTLUA_THROW(QtLua::UserData, "Table iteration is not handled by the `%' class",
@@ -26,6 +26,16 @@
 #include <QtLua/String>
 #include <QtLua/State>
 
+#if QT_VERSION >= 0x050000
+# include <QJsonArray>
+# include <QJsonObject>
+#endif
+#if QT_VERSION >= 0x050C00
+# include <QCborValue>
+# include <QCborArray>
+# include <QCborMap>
+#endif
+
 #include <internal/QMetaValue>
 #include <internal/QObjectWrapper>
 
@@ -132,6 +142,22 @@ Value & Value::operator=(double n)
   return *this;
 }
 
+Value & Value::operator=(long long n)
+{
+  if (_st)
+    {
+      lua_State *lst = _st->_lst;
+      lua_pushnumber(lst, _id);
+#if LUA_VERSION_NUM >= 503
+      lua_pushinteger(lst, n);
+#else
+      lua_pushnumber(lst, n);
+#endif
+      lua_rawset(lst, LUA_REGISTRYINDEX);
+    }
+  return *this;
+}
+
 Value & Value::operator=(const String &str)
 {
   if (_st)
@@ -188,6 +214,200 @@ Value & Value::operator=(const QVariant &qv)
   return *this;
 }
 
+#if QT_VERSION >= 0x050000
+
+static void json_to_lua(lua_State *st, const QJsonValue &json)
+{
+  if (!lua_checkstack(st, 3))
+    QTLUA_THROW(QtLua::Value, "Unable to extend the lua stack.");
+
+  switch (json.type())
+    {
+    case QJsonValue::Bool:
+      lua_pushboolean(st, json.toBool());
+      return;
+
+    case QJsonValue::Double: {
+      double n = json.toDouble();
+#if LUA_VERSION_NUM >= 503
+      // JSON numbers with integral values are stored as lua
+      // integers, provided the cast does not overflow
+      if (n >= -9223372036854775808.0 && n < 9223372036854775808.0 &&
+	  n == (double)(lua_Integer)n)
+	{
+	  lua_pushinteger(st, (lua_Integer)n);
+	  return;
+	}
+#endif
+      lua_pushnumber(st, n);
+      return;
+    }
+
+    case QJsonValue::String: {
+      QByteArray s(json.toString().toUtf8());
+      lua_pushlstring(st, s.constData(), s.size());
+      return;
+    }
+
+    case QJsonValue::Array: {
+      QJsonArray array(json.toArray());
+#if LUA_VERSION_NUM < 501
+      lua_newtable(st);
+#else
+      lua_createtable(st, array.size(), 0);
+#endif
+      for (int i = 0; i < array.size(); i++)
+	{
+	  json_to_lua(st, array.at(i));
+	  lua_rawseti(st, -2, i + 1);
+	}
+      return;
+    }
+
+    case QJsonValue::Object: {
+      QJsonObject object(json.toObject());
+#if LUA_VERSION_NUM < 501
+      lua_newtable(st);
+#else
+      lua_createtable(st, 0, object.size());
+#endif
+      for (QJsonObject::const_iterator i = object.constBegin(); i != object.constEnd(); ++i)
+	{
+	  QByteArray k(i.key().toUtf8());
+	  lua_pushlstring(st, k.constData(), k.size());
+	  json_to_lua(st, i.value());
+	  lua_rawset(st, -3);
+	}
+      return;
+    }
+
+    default:
+      lua_pushnil(st);
+      return;
+    }
+}
+
+Value Value::from_json(const State *ls, const QJsonValue &json)
+{
+  lua_State *lst = ls->_lst;
+  int top = lua_gettop(lst);
+
+  try {
+    json_to_lua(lst, json);
+  } catch (...) {
+    lua_settop(lst, top);
+    throw;
+  }
+
+  Value res(-1, ls);
+  lua_settop(lst, top);
+  return res;
+}
+
+#endif
+
+#if QT_VERSION >= 0x050C00
+
+static void cbor_to_lua(lua_State *st, const QCborValue &cbor)
+{
+  if (!lua_checkstack(st, 3))
+    QTLUA_THROW(QtLua::Value, "Unable to extend the lua stack.");
+
+  switch (cbor.type())
+    {
+    case QCborValue::False:
+    case QCborValue::True:
+      lua_pushboolean(st, cbor.toBool());
+      return;
+
+    case QCborValue::Integer:
+#if LUA_VERSION_NUM >= 503
+      lua_pushinteger(st, cbor.toInteger());
+#else
+      lua_pushnumber(st, cbor.toInteger());
+#endif
+      return;
+
+    case QCborValue::Double:
+      lua_pushnumber(st, cbor.toDouble());
+      return;
+
+    case QCborValue::String: {
+      QByteArray s(cbor.toString().toUtf8());
+      lua_pushlstring(st, s.constData(), s.size());
+      return;
+    }
+
+    case QCborValue::ByteArray: {
+      QByteArray s(cbor.toByteArray());
+      lua_pushlstring(st, s.constData(), s.size());
+      return;
+    }
+
+    case QCborValue::Array: {
+      QCborArray array(cbor.toArray());
+      lua_createtable(st, array.size(), 0);
+      for (qsizetype i = 0; i < array.size(); i++)
+	{
+	  cbor_to_lua(st, array.at(i));
+	  lua_rawseti(st, -2, i + 1);
+	}
+      return;
+    }
+
+    case QCborValue::Map: {
+      QCborMap map(cbor.toMap());
+      lua_createtable(st, 0, map.size());
+      for (QCborMap::ConstIterator i = map.constBegin(); i != map.constEnd(); ++i)
+	{
+	  cbor_to_lua(st, i.key());
+	  // lua tables can not have nil keys
+	  if (lua_isnil(st, -1))
+	    {
+	      lua_pop(st, 1);
+	      continue;
+	    }
+	  cbor_to_lua(st, i.value());
+	  lua_rawset(st, -3);
+	}
+      return;
+    }
+
+    case QCborValue::Tag:
+      cbor_to_lua(st, cbor.taggedValue());
+      return;
+
+    default:
+      lua_pushnil(st);
+      return;
+    }
+}
+
+Value Value::from_cbor(const State *ls, const QByteArray &cbor)
+{
+  QCborParserError error;
+  QCborValue value(QCborValue::fromCbor(cbor, &error));
+
+  if (error.error != QCborError::NoError)
+    QTLUA_THROW(QtLua::Value, "Unable to decode CBOR data: %.", .arg(error.errorString()));
+
+  lua_State *lst = ls->_lst;
+  int top = lua_gettop(lst);
+
+  try {
+    cbor_to_lua(lst, value);
+  } catch (...) {
+    lua_settop(lst, top);
+    throw;
+  }
+
+  Value res(-1, ls);
+  lua_settop(lst, top);
+  return res;
+}
+
+#endif
+
 Value & Value::operator=(const Value &lv)
 {
   if (_st && _st != lv._st)
@@ -23,6 +23,14 @@
 
 #include <QDebug>
 #include <QMetaMethod>
+#include <QSet>
+#if QT_VERSION >= 0x050000
+# include <QJsonArray>
+# include <QJsonObject>
+#endif
+#if QT_VERSION >= 0x050C00
+# include <QCborStreamWriter>
+#endif
 
 #include <QtLua/Value>
 #include <QtLua/ValueRef>
@@ -33,6 +41,7 @@
 #include <internal/QObjectWrapper>
 #include <internal/TableIterator>
 #include <internal/QMetaValue>
+#include <internal/PackedValue>
 
 extern "C" {
 #include <lua.h>
@@ -55,7 +64,7 @@ void ValueBase::check_state() const
     QTLUA_THROW(QtLua::ValueBase, "The associated State object has been destroyed.");
 }
 
-bool ValueBase::connect(QObject *obj, const char *signal)
+bool ValueBase::connect(QObject *obj, const char *signal, ConnectMode mode, int max_rate)
 {
   check_state();
   try {
@@ -67,7 +76,7 @@ bool ValueBase::connect(QObject *obj, const char *signal)
     if (sigid < 0 || mo->method(sigid).methodType() != QMetaMethod::Signal)
       return false;
 
-    qow->_lua_connect(sigid, *this);
+    qow->_lua_connect(sigid, *this, mode, max_rate);
 
   } catch (const String &e) {
     return false;
@@ -231,15 +240,18 @@ Value ValueBase::at(const Value &key) const
 
   switch (t)
     {
-    case TUserData: {
-      UserData::ptr ud = UserData::pop_ud(lst);
+    case TUserData:
+      if (!packed_value_type(lst, -1))
+	{
+	  UserData::ptr ud = UserData::pop_ud(lst);
 
-      if (!ud.valid())
-	QTLUA_THROW(QtLua::ValueBase, "Can not index a null `QtLua::UserData' value.");
+	  if (!ud.valid())
+	    QTLUA_THROW(QtLua::ValueBase, "Can not index a null `QtLua::UserData' value.");
 
-      return ud->meta_index(_st, key);
-    }
+	  return ud->meta_index(_st, key);
+	}
 
+      // packed values are indexed through their metatable
     case TTable: {
       try {
 	key.push_value(lst);
@@ -293,6 +305,13 @@ bool ValueBase::is_empty() const
     }
 
     case TUserData: {
+      int n = packed_value_len(lst, -1);
+      if (n >= 0)
+	{
+	  lua_pop(lst, 1);
+	  return n == 0;
+	}
+
       UserData::ptr ptr = UserData::pop_ud(lst);
       return ptr->meta_operation(_st, ValueBase::OpLen, *this, *this).to_integer() == 0;
     }
@@ -376,14 +395,19 @@ Ref<Iterator> ValueBase::new_iterator() const
 
   switch (int t = lua_type(lst, -1))
     {
-    case TUserData: {
-      UserData::ptr ud = UserData::pop_ud(lst);
+    case TUserData:
+      if (!packed_value_type(lst, -1))
+	{
+	  UserData::ptr ud = UserData::pop_ud(lst);
 
-      if (!ud.valid())
-	QTLUA_THROW(QtLua::ValueBase, "Can not iterate on a null `QtLua::UserData' value.");
+	  if (!ud.valid())
+	    QTLUA_THROW(QtLua::ValueBase, "Can not iterate on a null `QtLua::UserData' value.");
 
-      return ud->new_iterator(_st);
-    }
+	  return ud->new_iterator(_st);
+	}
+
+      // iterate on fields of packed values as on the equivalent table
+      packed_value_to_table(lst, -1);
 
     case TTable: {
       try {
@@ -451,6 +475,15 @@ String ValueBase::type_name_u() const
 	if (ud.valid())
 	  res = ud->get_type_name();
       } catch (const String &e) {
+	// raw userdata may provide a type name in its metatable
+	if (lua_getmetatable(lst, -1))
+	  {
+	    lua_pushstring(lst, "__name");
+	    lua_rawget(lst, -2);
+	    if (lua_type(lst, -1) == LUA_TSTRING)
+	      res = lua_tostring(lst, -1);
+	    lua_pop(lst, 2);
+	  }
       }
     }
 
@@ -473,6 +506,25 @@ void ValueBase::convert_error(ValueType type) const
 	      .arg(lua_typename(lst, type_b)).arg(lua_typename(lst, (int)type)));
 }
 
+long long ValueBase::to_longlong() const
+{
+#if LUA_VERSION_NUM >= 503
+  check_state();
+  lua_State *lst = _st->_lst;
+  push_value(lst);
+
+  int isint;
+  lua_Integer res = lua_tointegerx(lst, -1, &isint);
+  lua_pop(lst, 1);
+
+  if (isint)
+    return res;
+#endif
+
+  // not an integer value, also handles errors
+  return (long long)to_number();
+}
+
 lua_Number ValueBase::to_number() const
 {
   check_state();
@@ -528,6 +580,30 @@ String ValueBase::to_string() const
   std::abort();
 }
 
+String ValueBase::to_string_ref() const
+{
+  check_state();
+  lua_State *lst = _st->_lst;
+  push_value(lst);
+
+  if (lua_type(lst, -1) == TString)
+    {
+#if LUA_VERSION_NUM < 501
+      const char *s = lua_tostring(lst, -1);
+      size_t len = lua_strlen(lst, -1);
+#else
+      size_t len;
+      const char *s = lua_tolstring(lst, -1, &len);
+#endif
+      lua_pop(lst, 1);
+      // string buffer is kept alive by the lua value reference
+      return String(QByteArray::fromRawData(s, len));
+    }
+
+  lua_pop(lst, 1);
+  return to_string();
+}
+
 String ValueBase::to_string_p(bool quote_string) const
 {
   check_state();
@@ -556,7 +632,12 @@ String ValueBase::to_string_p(lua_State *st, int index, bool quote_string)
 
     case TNumber: {
       String res;
-      res.setNum(lua_tonumber(st, index));
+#if LUA_VERSION_NUM >= 503
+      if (lua_isinteger(st, index))
+	res.setNum((qlonglong)lua_tointeger(st, index));
+      else
+#endif
+	res.setNum(lua_tonumber(st, index));
       return res;
     }
 
@@ -626,11 +707,33 @@ QVariant ValueBase::to_qvariant() const
       return QVariant();
     case TBool:
       return QVariant(to_boolean());
-    case TNumber:
+    case TNumber: {
+#if LUA_VERSION_NUM >= 503
+      lua_State *lst = _st->_lst;
+      push_value(lst);
+      if (lua_isinteger(lst, -1))
+	{
+	  qlonglong i = lua_tointeger(lst, -1);
+	  lua_pop(lst, 1);
+	  return QVariant(i);
+	}
+      lua_pop(lst, 1);
+#endif
       return QVariant(to_number());
+    }
     case TString:
       return QVariant(to_string());
 
+    case TUserData: {
+      lua_State *lst = _st->_lst;
+      push_value(lst);
+      int qt_type = packed_value_type(lst, -1);
+      lua_pop(lst, 1);
+
+      if (qt_type)
+	return QMetaValue(qt_type, *this).to_qvariant();
+    }
+
     default:
       QTLUA_THROW(QtLua::ValueBase, "Can not convert a `%' lua value to a QVariant.", .arg(type_name()));
     }
@@ -641,6 +744,255 @@ QVariant ValueBase::to_qvariant(int qt_type) const
   return QMetaValue(qt_type, *this).to_qvariant();
 }
 
+#if QT_VERSION >= 0x050000
+
+/** Enter a table during serialization, detect cycles */
+static void table_enter(lua_State *st, int index, QSet<const void*> &visited)
+{
+  const void *p = lua_topointer(st, index);
+
+  if (visited.contains(p))
+    QTLUA_THROW(QtLua::ValueBase, "Can not serialize a recursive `lua::table' value.");
+
+  if (!lua_checkstack(st, 3))
+    QTLUA_THROW(QtLua::ValueBase, "Unable to extend the lua stack.");
+
+  visited.insert(p);
+}
+
+static QString json_key(lua_State *st, int index)
+{
+  switch (lua_type(st, index))
+    {
+    case LUA_TSTRING: {
+      size_t len;
+      const char *s = lua_tolstring(st, index, &len);
+      return QString::fromUtf8(s, len);
+    }
+
+    case LUA_TNUMBER:
+#if LUA_VERSION_NUM >= 503
+      if (lua_isinteger(st, index))
+	return QString::number((qlonglong)lua_tointeger(st, index));
+#endif
+      return QString::number(lua_tonumber(st, index));
+
+    default:
+      QTLUA_THROW(QtLua::ValueBase, "Can not use a `lua::%' value as a JSON object key.",
+		  .arg(lua_typename(st, lua_type(st, index))));
+    }
+}
+
+static QJsonValue lua_to_json(lua_State *st, int index, QSet<const void*> &visited)
+{
+  switch (lua_type(st, index))
+    {
+    case LUA_TNIL:
+      return QJsonValue(QJsonValue::Null);
+
+    case LUA_TBOOLEAN:
+      return QJsonValue((bool)lua_toboolean(st, index));
+
+    case LUA_TNUMBER:
+#if LUA_VERSION_NUM >= 503
+      if (lua_isinteger(st, index))
+	return QJsonValue((qint64)lua_tointeger(st, index));
+#endif
+      return QJsonValue((double)lua_tonumber(st, index));
+
+    case LUA_TSTRING: {
+      size_t len;
+      const char *s = lua_tolstring(st, index, &len);
+      return QJsonValue(QString::fromUtf8(s, len));
+    }
+
+    case LUA_TTABLE: {
+      QJsonValue res;
+      int len = QMetaValue::raw_len(st, index);
+
+      table_enter(st, index, visited);
+
+      if (len > 0)
+	{
+	  QJsonArray array;
+	  for (int i = 1; i <= len; i++)
+	    {
+	      lua_rawgeti(st, index, i);
+	      array.append(lua_to_json(st, lua_gettop(st), visited));
+	      lua_pop(st, 1);
+	    }
+	  res = array;
+	}
+      else
+	{
+	  QJsonObject object;
+	  lua_pushnil(st);
+	  while (lua_next(st, index))
+	    {
+	      object.insert(json_key(st, -2), lua_to_json(st, lua_gettop(st), visited));
+	      lua_pop(st, 1);
+	    }
+	  res = object;
+	}
+
+      visited.remove(lua_topointer(st, index));
+      return res;
+    }
+
+    case LUA_TUSERDATA:
+      if (packed_value_type(st, index))
+	{
+	  // serialize packed values as arrays of fields
+	  lua_pushvalue(st, index);
+	  packed_value_to_table(st, -1);
+	  QJsonValue res = lua_to_json(st, lua_gettop(st), visited);
+	  lua_pop(st, 1);
+	  return res;
+	}
+
+    default:
+      QTLUA_THROW(QtLua::ValueBase, "Can not convert a `lua::%' value to JSON.",
+		  .arg(lua_typename(st, lua_type(st, index))));
+    }
+}
+
+QJsonValue ValueBase::to_json() const
+{
+  check_state();
+  lua_State *lst = _st->_lst;
+  int top = lua_gettop(lst);
+  QSet<const void*> visited;
+  QJsonValue res;
+
+  push_value(lst);
+
+  try {
+    res = lua_to_json(lst, top + 1, visited);
+  } catch (...) {
+    lua_settop(lst, top);
+    throw;
+  }
+
+  lua_settop(lst, top);
+  return res;
+}
+
+#endif
+
+#if QT_VERSION >= 0x050C00
+
+static void lua_to_cbor(lua_State *st, int index, QCborStreamWriter &w,
+			QSet<const void*> &visited, bool key)
+{
+  switch (lua_type(st, index))
+    {
+    case LUA_TNIL:
+      w.append(nullptr);
+      return;
+
+    case LUA_TBOOLEAN:
+      w.append((bool)lua_toboolean(st, index));
+      return;
+
+    case LUA_TNUMBER:
+#if LUA_VERSION_NUM >= 503
+      if (lua_isinteger(st, index))
+	{
+	  w.append((qint64)lua_tointeger(st, index));
+	  return;
+	}
+#endif
+      w.append((double)lua_tonumber(st, index));
+      return;
+
+    case LUA_TSTRING: {
+      size_t len;
+      const char *s = lua_tolstring(st, index, &len);
+      w.appendTextString(s, len);
+      return;
+    }
+
+    case LUA_TTABLE: {
+      if (key)
+	break;
+
+      int len = QMetaValue::raw_len(st, index);
+
+      table_enter(st, index, visited);
+
+      if (len > 0)
+	{
+	  w.startArray(len);
+	  for (int i = 1; i <= len; i++)
+	    {
+	      lua_rawgeti(st, index, i);
+	      lua_to_cbor(st, lua_gettop(st), w, visited, false);
+	      lua_pop(st, 1);
+	    }
+	  w.endArray();
+	}
+      else
+	{
+	  // entry count is unknown, use an indefinite length map
+	  w.startMap();
+	  lua_pushnil(st);
+	  while (lua_next(st, index))
+	    {
+	      int top = lua_gettop(st);
+	      lua_to_cbor(st, top - 1, w, visited, true);
+	      lua_to_cbor(st, top, w, visited, false);
+	      lua_pop(st, 1);
+	    }
+	  w.endMap();
+	}
+
+      visited.remove(lua_topointer(st, index));
+      return;
+    }
+
+    case LUA_TUSERDATA:
+      if (key || !packed_value_type(st, index))
+	break;
+
+      // serialize packed values as arrays of fields
+      lua_pushvalue(st, index);
+      packed_value_to_table(st, -1);
+      lua_to_cbor(st, lua_gettop(st), w, visited, false);
+      lua_pop(st, 1);
+      return;
+
+    default:
+      break;
+    }
+
+  QTLUA_THROW(QtLua::ValueBase, "Can not convert a `lua::%' value to CBOR.",
+	      .arg(lua_typename(st, lua_type(st, index))));
+}
+
+QByteArray ValueBase::to_cbor() const
+{
+  check_state();
+  lua_State *lst = _st->_lst;
+  int top = lua_gettop(lst);
+  QSet<const void*> visited;
+  QByteArray res;
+  QCborStreamWriter w(&res);
+
+  push_value(lst);
+
+  try {
+    lua_to_cbor(lst, top + 1, w, visited, false);
+  } catch (...) {
+    lua_settop(lst, top);
+    throw;
+  }
+
+  lua_settop(lst, top);
+  return res;
+}
+
+#endif
+
 static int lua_writer(lua_State *L, const void* p, size_t sz, void* pv)
 {
   QByteArray *ba = (QByteArray*)pv;
@@ -706,6 +1058,13 @@ int ValueBase::len() const
       return res;
 
     case TUserData: {
+      int n = packed_value_len(lst, -1);
+      if (n >= 0)
+	{
+	  lua_pop(lst, 1);
+	  return n;
+	}
+
       UserData::ptr ptr = UserData::pop_ud(lst);
       return ptr->meta_operation(_st, ValueBase::OpLen, *this, *this).to_integer();
     }
@@ -810,6 +1169,34 @@ bool ValueBase::support(Operation c) const
       break;
 
     case TUserData:
+      if (packed_value_type(lst, -1))
+	{
+	  switch (c)
+	    {
+	    case ValueBase::OpEq:
+	    case ValueBase::OpLen:
+	    case ValueBase::OpIterate:
+	    case ValueBase::OpIndex:
+	    case ValueBase::OpNewindex:
+	      res = true;
+	      break;
+	    case ValueBase::OpAdd:
+	    case ValueBase::OpSub:
+	    case ValueBase::OpMul:
+	    case ValueBase::OpDiv:
+	    case ValueBase::OpUnm:
+	      // only some packed types provide arithmetic metamethods
+	      res = luaL_getmetafield(lst, -1, "__add");
+	      if (res)
+		lua_pop(lst, 1);
+	      break;
+	    default:
+	      res = false;
+	      break;
+	    }
+	  break;
+	}
+
       try {
 	UserData::ptr ptr = UserData::get_ud(lst, -1);
 	res = ptr->support(c);
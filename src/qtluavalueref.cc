@@ -22,6 +22,7 @@
 #include <cstdlib>
 
 #include <QtLua/ValueRef>
+#include <internal/PackedValue>
 
 extern "C" {
 #include <lua.h>
@@ -141,26 +142,29 @@ namespace QtLua {
 
     switch (t)
       {
-      case Value::TUserData: {
-	UserData::ptr ud = UserData::pop_ud(lst);
+      case Value::TUserData:
+	if (!packed_value_type(lst, -1))
+	  {
+	    UserData::ptr ud = UserData::pop_ud(lst);
 
-	if (!ud.valid())
-	  QTLUA_THROW(QtLua::ValueRef, "Can not index a null `QtLua::UserData' value.");
+	    if (!ud.valid())
+	      QTLUA_THROW(QtLua::ValueRef, "Can not index a null `QtLua::UserData' value.");
 
-	Value k(_st);
-	k._id = _key_id;	// reuse stored key id for temp Value
+	    Value k(_st);
+	    k._id = _key_id;	// reuse stored key id for temp Value
 
-	try {
-	  ud->meta_newindex(_st, k, v);
-	} catch (...) {
-	  k._st = 0;
-	  throw;
-	}
-	k._st = 0;
+	    try {
+	      ud->meta_newindex(_st, k, v);
+	    } catch (...) {
+	      k._st = 0;
+	      throw;
+	    }
+	    k._st = 0;
 
-	return;
-      }
+	    return;
+	  }
 
+	// packed values fields are set through their metatable
       case Value::TTable:
 	lua_pushnumber(lst, _key_id);
 	lua_rawget(lst, LUA_REGISTRYINDEX);
@@ -0,0 +1,491 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#include "test.hh"
+
+#include <QtLua/State>
+#include <QtLua/Value>
+#include <QtLua/Blob>
+#include <QtLua/NumArray>
+#include <QtLua/QVectorProxy>
+#include <QtLua/QListProxy>
+#include <QtLua/MappedArrayProxy>
+#include <QtLua/StdVectorProxy>
+#include <QtLua/StdDequeProxy>
+#include <QtLua/StdMapProxy>
+
+#include <QTemporaryFile>
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <string>
+#if __cplusplus >= 201103L
+# include <unordered_map>
+#endif
+
+using namespace QtLua;
+
+/* check that lua statements raise an error */
+static bool fails(QtLua::State &ls, const char *statements)
+{
+  try {
+    ls.exec_statements(statements);
+  } catch (QtLua::String &e) {
+    return true;
+  }
+  return false;
+}
+
+/* check that a C++ expression throws */
+#define THROWS(x)				\
+  do {						\
+    bool thrown_ = false;			\
+    try {					\
+      x;					\
+    } catch (QtLua::String &e) {		\
+      thrown_ = true;				\
+    }						\
+    ASSERT(thrown_);				\
+  } while (0)
+
+static int lua_int(QtLua::State &ls, const char *expr)
+{
+  return ls.exec_statements(String("return ") + expr).at(0).to_integer();
+}
+
+static void test_blob()
+{
+  QtLua::State ls;
+
+  QByteArray data("hello world");
+  Blob::ptr blob = QTLUA_REFNEW(Blob, data);
+  ls["blob"] = Value(&ls, blob);
+
+  // storage is shared, not copied
+  ASSERT(blob->data() == data.constData());
+  ASSERT(blob->sub(6, 5)->data() == data.constData() + 6);
+
+  ASSERT(lua_int(ls, "#blob") == 11);
+  ASSERT(lua_int(ls, "blob[1]") == 'h');
+  ASSERT(ls.exec_statements("return blob[0]")[0].is_nil());
+  ASSERT(ls.exec_statements("return blob[12]")[0].is_nil());
+  ASSERT(ls.exec_statements("return blob:sub(7):tostring()")[0].to_string() == "world");
+  ASSERT(ls.exec_statements("return blob:sub(-5, -2):tostring()")[0].to_string() == "worl");
+  ASSERT(lua_int(ls, "#blob:sub(20)") == 0);
+  ASSERT(lua_int(ls, "blob:find('o', 6)") == 8);
+  ASSERT(ls.exec_statements("return blob:find('z')")[0].is_nil());
+
+  // blobs are read only
+  ASSERT(fails(ls, "blob[1] = 0"));
+  THROWS(blob->sub(6, 6));
+}
+
+static void test_numarray()
+{
+  QtLua::State ls;
+
+  QVector<double> v;
+  v << 1 << 2 << 3 << 4 << 5;
+  NumArray<double>::ptr a = QTLUA_REFNEW(NumArray<double>, v);
+  NumArray<double>::ptr b = QTLUA_REFNEW(NumArray<double>, 5);
+  NumArray<double>::ptr c = QTLUA_REFNEW(NumArray<double>, 3);
+
+  ls["a"] = Value(&ls, a);
+  ls["b"] = Value(&ls, b);
+  ls["c"] = Value(&ls, c);
+
+  ls.exec_statements("b:copy_from(a) b:scale(2) b:axpy(-1, a)");
+  ASSERT(b->get_vector() == v);
+  ASSERT(a->get_vector() == v);
+
+  ASSERT(ls.exec_statements("return a:sum()")[0].to_number() == 15.);
+  ASSERT(ls.exec_statements("return a:dot(b)")[0].to_number() == 55.);
+  ASSERT(ls.exec_statements("return a:slice(2, 3):max()")[0].to_number() == 3.);
+  ASSERT(ls.exec_statements("return a:slice(2, 3):min()")[0].to_number() == 2.);
+  ASSERT(ls.exec_statements("return a[6]")[0].is_nil());
+
+  // sizes must match and ranges must be in bounds
+  ASSERT(fails(ls, "a:axpy(1, c)"));
+  ASSERT(fails(ls, "a:dot(c)"));
+  ASSERT(fails(ls, "c:copy_from(a)"));
+  ASSERT(fails(ls, "a:copy_from(c, 4)"));
+  ASSERT(fails(ls, "a[6] = 1"));
+  ASSERT(fails(ls, "a:map('foo')"));
+  ASSERT(fails(ls, "a:slice(4, 3):min()"));
+  THROWS(a->slice(3, 3));
+
+  ls.exec_statements("c:copy_from(a:slice(3))");
+  ASSERT(c->data()[0] == 3. && c->data()[2] == 5.);
+
+  // integral sums do not wrap at the element type width
+  NumArray<qint32>::ptr i = QTLUA_REFNEW(NumArray<qint32>, 3);
+  i->data()[0] = i->data()[1] = i->data()[2] = 1000000000;
+  ASSERT(i->sum() == 3000000000LL);
+  ASSERT(i->dot(*i) == 3000000000000000000LL);
+  ls["i"] = Value(&ls, i);
+  ASSERT(ls.exec_statements("return i:sum()")[0].to_number() == 3e9);
+
+  QtLua::State qls;
+  qls.openlib(QtLib);
+
+  ASSERT(lua_int(qls, "qt.new_numarray('int32', { 1, 2, 3 }):sum()") == 6);
+  ASSERT(lua_int(qls, "qt.new_numarray('float', 4):sum()") == 0);
+  ASSERT(fails(qls, "qt.new_numarray('int32', -1)"));
+  ASSERT(fails(qls, "qt.new_numarray('int16', 4)"));
+}
+
+static void test_range_methods()
+{
+  QtLua::State ls;
+
+  QVector<int> v;
+  v << 1 << 2 << 3 << 4 << 5;
+  QVectorProxy<QVector<int> >::ptr p = QTLUA_REFNEW(QVectorProxy<QVector<int> >, v);
+  QVectorProxyRo<QVector<int> >::ptr ro = QTLUA_REFNEW(QVectorProxyRo<QVector<int> >, v);
+
+  ls["p"] = Value(&ls, p);
+  ls["ro"] = Value(&ls, ro);
+
+  ls.exec_statements("p:set(2, { 20, 30 })");
+  ASSERT(v[1] == 20 && v[2] == 30);
+
+  Value::List res = ls.exec_statements("return p:get(2, 3)");
+  ASSERT(res.size() == 3);
+  ASSERT(res[0].to_integer() == 20 && res[2].to_integer() == 4);
+
+  // reading past the end returns less values
+  ASSERT(ls.exec_statements("return p:get(4, 10)").size() == 2);
+  ASSERT(ls.exec_statements("return p:get(6)").size() == 0);
+
+  ASSERT(lua_int(ls, "#p:slice(-2)") == 2);
+  ASSERT(lua_int(ls, "p:slice(-2)[1]") == 4);
+  ASSERT(lua_int(ls, "#p:slice(4, 2)") == 0);
+
+  // writes are bounded, checked before any element is written and
+  // not allowed on read only proxies
+  ASSERT(fails(ls, "p:set(5, { 50, 60 })"));
+  ASSERT(v.size() == 5 && v[4] == 5);
+  ASSERT(fails(ls, "p:set(0, { 0 })"));
+  ASSERT(fails(ls, "ro:set(1, { 0 })"));
+  ASSERT(v[0] == 1);
+  ASSERT(lua_int(ls, "ro:get(1)") == 1);
+
+  // resizable vector is bounded by its maximum size
+  QVector<int> w;
+  w << 1 << 2;
+  typedef QVectorProxy<QVector<int>, 4> ResizeProxy;
+  ResizeProxy::ptr rp = QTLUA_REFNEW(ResizeProxy, w);
+  ls["rp"] = Value(&ls, rp);
+
+  ls.exec_statements("rp:set(2, { 20, 30 })");
+  ASSERT(w.size() == 3 && w[2] == 30);
+  ASSERT(fails(ls, "rp:set(3, { 0, 40, 50 })"));
+  ASSERT(w.size() == 3 && w[2] == 30);
+  ls.exec_statements("rp:set(3, { 0, 40 })");
+  ASSERT(w.size() == 4 && w[3] == 40);
+
+  // detached container
+  p->set_container(0);
+  ASSERT(ls.exec_statements("return p:get(1)").size() == 0);
+  ASSERT(lua_int(ls, "#p:slice(1)") == 0);
+  ASSERT(fails(ls, "p:set(1, { 0 })"));
+}
+
+static void test_snapshot_iteration()
+{
+  QtLua::State ls;
+
+  QVector<int> v;
+  v << 1 << 2 << 3;
+  QList<int> l;
+  l << 1 << 2 << 3;
+
+  QVectorProxy<QVector<int> >::ptr vp = QTLUA_REFNEW(QVectorProxy<QVector<int> >, v);
+  QListProxy<QList<int> >::ptr lp = QTLUA_REFNEW(QListProxy<QList<int> >, l);
+  Value pv(&ls, vp);
+  Value pl(&ls, lp);
+  int sum;
+
+  // iterators read the live container by default
+  sum = 0;
+  for (Value::const_iterator i = pv.begin(); i != pv.end(); i++)
+    {
+      if (i.key().to_integer() == 1)
+	v[2] = 30;
+      sum += i.value().to_integer();
+    }
+  ASSERT(sum == 33);
+
+  sum = 0;
+  for (Value::iterator i = pl.begin(); i != pl.end(); i++)
+    {
+      if (i.key().to_integer() == 1)
+	l.append(4);
+      sum += i.value().to_integer();
+    }
+  ASSERT(sum == 10);
+
+  // snapshot iterators ignore changes made from C++ during iteration
+  vp->set_snapshot(true);
+  lp->set_snapshot(true);
+
+  sum = 0;
+  for (Value::iterator i = pv.begin(); i != pv.end(); i++)
+    {
+      if (i.key().to_integer() == 1)
+	{
+	  v[1] = 20;
+	  v.append(40);
+	}
+      sum += i.value().to_integer();
+    }
+  ASSERT(sum == 33 && v.size() == 4 && v[1] == 20);
+
+  sum = 0;
+  for (Value::const_iterator i = pl.begin(); i != pl.end(); i++)
+    {
+      if (i.key().to_integer() == 2)
+	l.clear();
+      sum += i.value().to_integer();
+    }
+  ASSERT(sum == 10 && l.isEmpty());
+
+  // values references of snapshot iterators can not be assigned
+  THROWS(pv.begin().value() = Value(&ls, 0));
+  ASSERT(v[0] == 1);
+  ls.check_empty_stack();
+}
+
+static void test_mapped_array()
+{
+  QtLua::State ls;
+
+  QTemporaryFile f;
+  ASSERT(f.open());
+
+  // 4 bytes header then 4 records of 8 bytes
+  qint32 v[9] = { 0, 1, -1, 2, -1, 3, -1, 4, -1 };
+  ASSERT(f.write((const char*)v, sizeof(v)) == sizeof(v));
+  f.flush();
+
+  MappedArrayProxy<qint32>::ptr rw
+    = QTLUA_REFNEW(MappedArrayProxy<qint32>, f.fileName(), true, 4, 8);
+  MappedArrayProxy<qint32>::ptr ro
+    = QTLUA_REFNEW(MappedArrayProxy<qint32>, f.fileName(), false, 4, 8, 2);
+
+  ls["rw"] = Value(&ls, rw);
+  ls["ro"] = Value(&ls, ro);
+
+  ASSERT(rw->size() == 4 && ro->size() == 2);
+  ASSERT(lua_int(ls, "#rw") == 4);
+  ASSERT(lua_int(ls, "rw[4]") == 4);
+  ASSERT(ls.exec_statements("return rw[0]")[0].is_nil());
+  ASSERT(ls.exec_statements("return rw[5]")[0].is_nil());
+
+  ls.exec_statements("rw[2] = 20");
+  ASSERT(rw->at(1) == 20);
+  ASSERT(lua_int(ls, "ro[2]") == 20);
+
+  ASSERT(lua_int(ls, "(function() local s = 0 for k, v in each(rw) do s = s + v end return s end)()") == 28);
+  ASSERT(lua_int(ls, "rw:slice(2)[3]") == 4);
+
+  ASSERT(fails(ls, "rw[5] = 0"));
+  ASSERT(fails(ls, "ro[1] = 0"));
+  ASSERT(fails(ls, "ro:set(1, { 0 })"));
+  ASSERT(ro->at(0) == 1);
+
+  // bad layouts
+  THROWS(QTLUA_REFNEW(MappedArrayProxy<qint32>, f.fileName(), false, 4, 8, 5));
+  THROWS(QTLUA_REFNEW(MappedArrayProxy<qint32>, f.fileName(), false, 0, 2));
+  THROWS(QTLUA_REFNEW(MappedArrayProxy<qint32>, f.fileName() + ".none"));
+
+  MappedArrayProxy<qint32>::ptr empty
+    = QTLUA_REFNEW(MappedArrayProxy<qint32>, f.fileName(), false, 36);
+  ASSERT(empty->size() == 0);
+}
+
+static void test_std_vector()
+{
+  QtLua::State ls;
+
+  typedef StdVectorProxy<std::vector<int>, 4, 2> ResizeProxy;
+  typedef StdVectorProxy<std::vector<int> > FixedProxy;
+  typedef StdVectorProxyRo<std::vector<int> > RoProxy;
+
+  std::vector<int> v(3, 1);
+  ResizeProxy::ptr p = QTLUA_REFNEW(ResizeProxy, v);
+
+  ls["v"] = Value(&ls, p);
+  ls["f"] = Value(&ls, QTLUA_REFNEW(FixedProxy, v));
+  ls["ro"] = Value(&ls, QTLUA_REFNEW(RoProxy, v));
+
+  // live container, no copy
+  v[0] = 7;
+  ASSERT(lua_int(ls, "v[1]") == 7);
+  ASSERT(lua_int(ls, "ro[1]") == 7);
+
+  // resize bounds
+  ls.exec_statements("v[4] = 5");
+  ASSERT(v.size() == 4 && v[3] == 5);
+  ASSERT(fails(ls, "v[5] = 6"));
+  ls.exec_statements("v[3] = nil");
+  ASSERT(v.size() == 2);
+  ASSERT(fails(ls, "v[2] = nil"));
+  ASSERT(v.size() == 2);
+
+  // no resize allowed
+  ASSERT(fails(ls, "f[3] = 0"));
+  ASSERT(fails(ls, "ro[1] = 0"));
+
+  Value::List res = ls.exec_statements("return v:get(1, 2)");
+  ASSERT(res.size() == 2 && res[0].to_integer() == 7);
+  ASSERT(lua_int(ls, "#-v") == 2);
+
+  // detached container
+  p->set_container(0);
+  ASSERT(ls.exec_statements("return v[1]")[0].is_nil());
+  ASSERT(lua_int(ls, "#v") == 0);
+  ASSERT(fails(ls, "v[1] = 0"));
+  ASSERT(fails(ls, "for k, x in each(v) do end"));
+}
+
+static void test_std_deque()
+{
+  QtLua::State ls;
+
+  std::deque<int> d;
+  d.push_back(1);
+  d.push_back(2);
+  d.push_back(3);
+
+  ls["d"] = Value(&ls, QTLUA_REFNEW(StdDequeProxy<std::deque<int> >, d));
+
+  ls.exec_statements("d[1] = 10");
+  ASSERT(d.front() == 10);
+  ASSERT(fails(ls, "d[4] = 4"));
+
+  ASSERT(lua_int(ls, "#d:slice(2)") == 2);
+  ASSERT(lua_int(ls, "d:slice(2)[2]") == 3);
+  ASSERT(ls.exec_statements("return d:get(2, 5)").size() == 2);
+  ASSERT(lua_int(ls, "(function() local s = 0 for k, v in each(d) do s = s + v end return s end)()") == 15);
+}
+
+static void test_std_map()
+{
+  QtLua::State ls;
+
+  typedef std::map<String, int> Map;
+  typedef StdMapProxy<Map> MapProxy;
+  typedef StdMapProxyRo<Map> RoProxy;
+
+  Map m;
+  m["foo"] = 1;
+  MapProxy::ptr p = QTLUA_REFNEW(MapProxy, m);
+
+  ls["m"] = Value(&ls, p);
+  ls["ro"] = Value(&ls, QTLUA_REFNEW(RoProxy, m));
+
+  ls.exec_statements("m.bar = 5 m.foo = nil");
+  ASSERT(m.size() == 1 && m["bar"] == 5);
+  ASSERT(ls.exec_statements("return m.foo")[0].is_nil());
+  ASSERT(lua_int(ls, "ro.bar") == 5);
+  ASSERT(lua_int(ls, "#m") == 1);
+  ASSERT(lua_int(ls, "(-m).bar") == 5);
+  ASSERT(fails(ls, "ro.bar = 1"));
+
+  // detached container
+  p->set_container(0);
+  ASSERT(ls.exec_statements("return m.bar")[0].is_nil());
+  ASSERT(fails(ls, "m.bar = 1"));
+
+#if __cplusplus >= 201103L
+  typedef std::unordered_map<String, double> UMap;
+  typedef StdMapProxy<UMap> UMapProxy;
+
+  UMap u;
+  u["pi"] = 3.5;
+
+  ls["u"] = Value(&ls, QTLUA_REFNEW(UMapProxy, u));
+
+  ls.exec_statements("u.e = u.pi * 2 u.pi = nil");
+  ASSERT(u.size() == 1 && u["e"] == 7.);
+#endif
+
+  // std::string keys
+  typedef std::map<std::string, int> SMap;
+  typedef StdMapProxy<SMap> SMapProxy;
+
+  SMap sm;
+  sm["foo"] = 1;
+  ls["sm"] = Value(&ls, QTLUA_REFNEW(SMapProxy, sm));
+
+  ls.exec_statements("sm.bar = sm.foo + 1 sm.foo = nil sm['a\\0b'] = 3");
+  ASSERT(sm.size() == 2 && sm["bar"] == 2 && sm[std::string("a\0b", 3)] == 3);
+  ASSERT(lua_int(ls, "sm['a\\0b']") == 3);
+  ASSERT(ls.exec_statements("return sm.foo")[0].is_nil());
+  ASSERT(ls.exec_statements("local n = 0 for k, v in each(sm) do n = n + #k + v end "
+			    "return n")[0].to_integer() == 11);
+
+#if __cplusplus >= 201402L
+  // transparent comparator
+  typedef std::map<std::string, int, std::less<> > TMap;
+  typedef StdMapProxy<TMap> TMapProxy;
+
+  TMap tm;
+  tm["foo"] = 1;
+  ls["tm"] = Value(&ls, QTLUA_REFNEW(TMapProxy, tm));
+
+  ls.exec_statements("tm.bar = tm.foo + 1 tm.foo = nil");
+  ASSERT(tm.size() == 1 && tm["bar"] == 2);
+  ASSERT(lua_int(ls, "tm.bar") == 2 && lua_int(ls, "(-tm).bar") == 2);
+#endif
+
+#if __cplusplus >= 201103L
+  typedef std::unordered_map<std::string, int> SUMap;
+  typedef StdMapProxy<SUMap> SUMapProxy;
+
+  SUMap su;
+  ls["su"] = Value(&ls, QTLUA_REFNEW(SUMapProxy, su));
+
+  ls.exec_statements("su.x = 1 su.y = su.x + 1");
+  ASSERT(su.size() == 2 && su["y"] == 2);
+#endif
+}
+
+int main()
+{
+  try {
+    test_blob();
+    test_numarray();
+    test_range_methods();
+    test_snapshot_iteration();
+    test_mapped_array();
+    test_std_vector();
+    test_std_deque();
+    test_std_map();
+
+  } catch (QtLua::String &e) {
+    std::cout << e.constData() << std::endl;
+    ASSERT(0);
+  }
+
+  return 0;
+}
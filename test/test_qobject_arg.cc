@@ -19,10 +19,46 @@
 */
 
 #include <QApplication>
+#include <QElapsedTimer>
+#include <QThread>
 
 #include "test.hh"
 #include "test_qobject_arg.hh"
 
+/* process events until the lua expression is true or timeout expires */
+static bool wait_for(QtLua::State &ls, const char *expr, int timeout = 2000)
+{
+  QElapsedTimer t;
+  t.start();
+
+  do {
+    QCoreApplication::processEvents();
+    if (ls.exec_statements(String("return ") + expr).at(0).to_boolean())
+      return true;
+  } while (t.elapsed() < timeout);
+
+  return false;
+}
+
+/* emit signals of an object from a worker thread */
+struct EmitThread : public QThread
+{
+  EmitThread(MyObjectNum *obj, int count)
+    : _obj(obj),
+      _count(count)
+  {
+  }
+
+  void run()
+  {
+    for (int i = 1; i <= _count; i++)
+      _obj->send(i);
+  }
+
+  MyObjectNum *_obj;
+  int _count;
+};
+
 int main(int argc, char **argv)
 {
   QApplication app(argc, argv);
@@ -88,6 +124,10 @@ int main(int argc, char **argv)
     ASSERT(ls.at("v").at("objectName").to_string() == "qo");
     ls.check_empty_stack();
 
+    ls.exec_statements("v.objectName = 'renamed'");
+    ASSERT(qo->objectName() == "renamed");
+    ls.check_empty_stack();
+
     //    ASSERT(ls["f"].disconnect(myobj, "qo_arg(QtLua::UserData::ptr)"));
 
     ls["o"] = myobj;
@@ -97,6 +137,120 @@ int main(int argc, char **argv)
     ASSERT(myobj->_qo == qo);
   }
 
+  {
+    QtLua::State ls;
+
+    ls.openlib(QtLua::QtLib);
+
+    QObject *qo = new QObject();
+    ls["o"] = qo;
+
+    ls.exec_statements("qt.props.set(o, { objectName = 'bulk' })");
+    ASSERT(qo->objectName() == "bulk");
+
+    QtLua::Value::List r = ls.exec_statements("return qt.props.get(o, { 'objectName' }).objectName");
+    ASSERT(r[0].to_string() == "bulk");
+    ls.check_empty_stack();
+  }
+
+  {
+    QtLua::State ls;
+
+    ls.openlib(QtLua::QtLib);
+
+    MyObjectNum *myobj = new MyObjectNum();
+    ls["o"] = myobj;
+
+    ls.exec_statements("calls = 0 function f(obj, n) calls = calls + 1; v = n; end "
+		       "function g(obj, b) calls = calls + 1; batch = b; end");
+
+    // latest mode only delivers the last emission from the event loop
+    ASSERT(ls.at("f").connect(myobj, "num_arg(int)", Value::ConnectLatest));
+    myobj->send(1);
+    myobj->send(2);
+    myobj->send(3);
+    ASSERT(ls.at("calls").to_integer() == 0);
+    ASSERT(wait_for(ls, "calls == 1"));
+    ASSERT(ls.at("v").to_integer() == 3);
+    ASSERT(ls.at("f").disconnect(myobj, "num_arg(int)"));
+
+    // batch mode delivers all pending emissions in a single call
+    ls.exec_statements("calls = 0 qt.connect(o, 'num_arg(int)', g, 'batch')");
+    myobj->send(4);
+    myobj->send(5);
+    myobj->send(6);
+    ASSERT(wait_for(ls, "calls == 1"));
+    ASSERT(ls.exec_statements("return #batch == 3 and batch[1][1] == 4 and batch[3][1] == 6").at(0).to_boolean());
+    ASSERT(ls.at("g").disconnect(myobj, "num_arg(int)"));
+
+    // max_rate delays the next delivery
+    ls.exec_statements("calls = 0 qt.connect(o, 'num_arg(int)', f, 'latest', 10)");
+    myobj->send(7);
+    ASSERT(wait_for(ls, "calls == 1"));
+    QElapsedTimer t;
+    t.start();
+    myobj->send(8);
+    ASSERT(wait_for(ls, "calls == 2"));
+    ASSERT(t.elapsed() >= 50);
+    ASSERT(ls.at("v").to_integer() == 8);
+    ASSERT(ls.at("f").disconnect(myobj, "num_arg(int)"));
+
+    // rates above 1000 per second are still delivered
+    ls.exec_statements("calls = 0 qt.connect(o, 'num_arg(int)', f, 'latest', 5000)");
+    myobj->send(9);
+    ASSERT(wait_for(ls, "calls == 1"));
+    myobj->send(10);
+    ASSERT(wait_for(ls, "calls == 2"));
+    ASSERT(ls.at("f").disconnect(myobj, "num_arg(int)"));
+
+    // bad mode is rejected
+    bool err = false;
+    try {
+      ls.exec_statements("qt.connect(o, 'num_arg(int)', f, 'foo')");
+    } catch (QtLua::String &e) {
+      err = true;
+    }
+    ASSERT(err);
+
+    // a wrapper and a slot signature still select a Qt slot
+    MyObjectNum *myobj2 = new MyObjectNum();
+    ls["o2"] = myobj2;
+    ls.exec_statements("qt.connect(o, 'num_arg(int)', o2, 'num_slot(int)')");
+    myobj->send(11);
+    ASSERT(myobj2->_num == 11);
+    ls.check_empty_stack();
+  }
+
+  {
+    QtLua::State ls;
+
+    ls.openlib(QtLua::QtLib);
+
+    MyObjectNum *myobj = new MyObjectNum();
+    ls["o"] = myobj;
+
+    ls.exec_statements("calls = 0 sum = 0 function f(obj, n) calls = calls + 1 sum = sum + n end "
+		       "function g(obj, n) stale = true end");
+
+    // emissions from an other thread are queued to the State thread
+    ASSERT(ls.at("f").connect(myobj, "num_arg(int)"));
+    EmitThread t(myobj, 10);
+    t.start();
+    t.wait();
+    ASSERT(ls.at("calls").to_integer() == 0);
+    ASSERT(wait_for(ls, "calls == 10"));
+    ASSERT(ls.at("sum").to_integer() == 55);
+
+    // queued calls of a disconnected slot do not reach a new connection
+    t.start();
+    t.wait();
+    ASSERT(ls.at("f").disconnect(myobj, "num_arg(int)"));
+    ASSERT(ls.at("g").connect(myobj, "num_arg(int)"));
+    ASSERT(!wait_for(ls, "stale", 200));
+    ASSERT(ls.at("calls").to_integer() == 10);
+    ls.check_empty_stack();
+  }
+
 #if QT_VERSION >= 0x040500
   {
     QtLua::State ls;
@@ -109,9 +263,110 @@ int main(int argc, char **argv)
 
     r = ls.exec_statements("return a:foo(2)");
     ASSERT(r[0].to_number() == 84);
+
+    // numeric string converted by fallback to conversion attempts
+    r = ls.exec_statements("return qt.new_qobject(qt.meta.MyObjectUD, '42', nil)");
+    ASSERT(r[0].type() == Value::TUserData);
+  }
+
+  {
+    QtLua::State ls;
+
+    ls.openlib(QtLua::QtLib);
+    ls.register_qobject_meta<MyObjectCtor>();
+
+    // exact lua types match selects the constructor
+    MyObjectCtor *o = static_cast<MyObjectCtor*>(
+      ls.exec_statements("return qt.new_qobject(qt.meta.MyObjectCtor, 'abc', true)")[0].to_qobject());
+    ASSERT(o->_ctor == 3 && o->_num == 3);
+
+    o = static_cast<MyObjectCtor*>(
+      ls.exec_statements("return qt.new_qobject(qt.meta.MyObjectCtor, true, 'ab')")[0].to_qobject());
+    ASSERT(o->_ctor == 2 && o->_num == 2);
+
+    // same lua types signature is resolved from cache
+    o = static_cast<MyObjectCtor*>(
+      ls.exec_statements("return qt.new_qobject(qt.meta.MyObjectCtor, false, 'abcd')")[0].to_qobject());
+    ASSERT(o->_ctor == 2 && o->_num == 4);
+
+    o = static_cast<MyObjectCtor*>(
+      ls.exec_statements("return qt.new_qobject(qt.meta.MyObjectCtor, 7)")[0].to_qobject());
+    ASSERT(o->_ctor == 1 && o->_num == 7);
+
+    // numeric string does not match exactly but can be converted
+    o = static_cast<MyObjectCtor*>(
+      ls.exec_statements("return qt.new_qobject(qt.meta.MyObjectCtor, '12')")[0].to_qobject());
+    ASSERT(o->_ctor == 1 && o->_num == 12);
+
+    bool err = false;
+    try {
+      ls.exec_statements("qt.new_qobject(qt.meta.MyObjectCtor, {})");
+    } catch (QtLua::String &e) {
+      err = true;
+    }
+    ASSERT(err);
   }
 #endif
 
+  {
+    QtLua::State ls;
+
+    ls.openlib(QtLua::BaseLib);
+    ls.openlib(QtLua::QtLuaLib);
+
+    MyObjectGeom *myobj = new MyObjectGeom();
+    myobj->_pos = QPoint(3, 4);
+    ls["o"] = myobj;
+
+    // packed property values are usable from C++
+    Value p = ls.at("o").at("pos");
+    ASSERT(p.at(1).to_integer() == 3 && p.at("y").to_integer() == 4);
+    ASSERT(p.len() == 2 && !p.is_empty());
+    ASSERT(p.to_qvariant().toPoint() == QPoint(3, 4));
+
+    int n = 0;
+    for (Value::const_iterator i = p.begin(); i != p.end(); i++)
+      n += i.value().to_integer();
+    ASSERT(n == 7);
+
+    ls["q"] = p;
+    p["x"] = Value(&ls, 5);
+    ASSERT(ls.exec_statements("return q.x == 5 and q.y == 4").at(0).to_boolean());
+
+    ls.exec_statements("o.pos = q o:list_slot({ q, 1 })");
+    ASSERT(myobj->_pos == QPoint(5, 4));
+    ASSERT(myobj->_list.size() == 2 && myobj->_list.at(0).toPoint() == QPoint(5, 4));
+
+    ASSERT(ls.exec_statements("local s = 0 for k, v in pairs(q) do s = s + k * v end "
+			      "return s == 13").at(0).to_boolean());
+    ls.check_empty_stack();
+
+    // multiple properties access, inherited properties included
+    ls.openlib(QtLua::QtLib);
+    ls.exec_statements("qt.props.set(o, { objectName = 'geom', pos = q * 2 })");
+    ASSERT(myobj->objectName() == "geom" && myobj->_pos == QPoint(10, 8));
+    ASSERT(ls.exec_statements("local t = qt.props.get(o, { 'pos', 'objectName' }) "
+			      "return t.objectName == 'geom' and t.pos.x == 10").at(0).to_boolean());
+    ls.check_empty_stack();
+
+    bool err = false;
+    try {
+      ls.exec_statements("qt.props.get(o, { 'pos', 'foo' })");
+    } catch (QtLua::String &e) {
+      err = true;
+    }
+    ASSERT(err);
+
+    err = false;
+    try {
+      ls.exec_statements("qt.props.set(o, { foo = 1 })");
+    } catch (QtLua::String &e) {
+      err = true;
+    }
+    ASSERT(err);
+    ls.check_empty_stack();
+  }
+
   } catch (QtLua::String &e) {
     std::cout << e.constData() << std::endl;
     ASSERT(0);
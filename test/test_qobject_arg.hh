@@ -24,6 +24,8 @@
 
 #include <QDebug>
 #include <QObject>
+#include <QPoint>
+#include <QVariant>
 
 using namespace QtLua;
 
@@ -72,6 +74,51 @@ public:
 
 };
 
+struct MyObjectCtor : public QObject
+{
+  Q_OBJECT;
+public:
+  MyObjectCtor()
+    : QObject(0),
+      _ctor(0),
+      _num(0)
+  {
+  }
+
+#if QT_VERSION >= 0x040500
+  Q_INVOKABLE
+#endif
+  MyObjectCtor(int num)
+    : QObject(0),
+      _ctor(1),
+      _num(num)
+  {
+  }
+
+#if QT_VERSION >= 0x040500
+  Q_INVOKABLE
+#endif
+  MyObjectCtor(bool b, const QString &str)
+    : QObject(0),
+      _ctor(2),
+      _num(str.size())
+  {
+  }
+
+#if QT_VERSION >= 0x040500
+  Q_INVOKABLE
+#endif
+  MyObjectCtor(const QString &str, bool b)
+    : QObject(0),
+      _ctor(3),
+      _num(str.size())
+  {
+  }
+
+  int _ctor;
+  int _num;
+};
+
 struct MyData : public UserData
 {
   MyData(double d)
@@ -114,3 +161,60 @@ public:
   void qo_arg(QObject *o);
 };
 
+struct MyObjectNum : public QObject
+{
+  Q_OBJECT;
+public:
+  MyObjectNum()
+    : QObject(0),
+      _num(0)
+  {
+  }
+
+  void send(int num)
+  {
+    emit num_arg(num);
+  }
+
+  int _num;
+
+ public slots:
+  void num_slot(int num)
+  {
+    _num = num;
+  }
+
+ signals:
+  void num_arg(int num);
+};
+
+struct MyObjectGeom : public QObject
+{
+  Q_OBJECT;
+  Q_PROPERTY(QPoint pos READ pos WRITE set_pos);
+public:
+  MyObjectGeom()
+    : QObject(0)
+  {
+  }
+
+  QPoint pos() const
+  {
+    return _pos;
+  }
+
+  void set_pos(const QPoint &p)
+  {
+    _pos = p;
+  }
+
+  QPoint _pos;
+  QVariantList _list;
+
+ public slots:
+  void list_slot(const QVariantList &l)
+  {
+    _list = l;
+  }
+};
+
@@ -23,9 +23,44 @@
 
 #include <QtLua/State>
 #include <QtLua/Value>
+#include <QtLua/DispatchProxy>
+#include <QtLua/QHashProxy>
 
 using namespace QtLua;
 
+/* only provides meta_index and meta_contains, probes are counted */
+struct RouteProbe : public UserData
+{
+  QTLUA_REFTYPE(RouteProbe);
+
+  RouteProbe(const String &key, int value)
+    : _key(key),
+      _value(value),
+      _probes(0)
+  {
+  }
+
+  Value meta_index(State *ls, const Value &key)
+  {
+    return key.to_string() == _key ? Value(ls, _value) : Value(ls);
+  }
+
+  bool meta_contains(State *ls, const Value &key)
+  {
+    _probes++;
+    return key.to_string() == _key;
+  }
+
+  bool support(Value::Operation c) const
+  {
+    return c == Value::OpIndex;
+  }
+
+  String _key;
+  int _value;
+  int _probes;
+};
+
 int main()
 {
   try {
@@ -149,6 +184,36 @@ int main()
     ls.check_empty_stack();
   }
 
+  {
+    QtLua::State ls;
+
+    ls.openlib(AllLibs);
+
+    ls.exec_statements("t = { a = 1, b = 2, c = 3 } "
+		       "function sum(x) local s = 0 for k, v in each(x) do s = s + v end return s end");
+
+    // plain tables are iterated with the native next function
+    ASSERT(ls.exec_statements("return each(t) == next").at(0).to_boolean());
+    ASSERT(ls.exec_statements("return sum(t)").at(0).to_integer() == 6);
+    ls.check_empty_stack();
+
+    // tables with a metatable still use the table iterator
+    ls.exec_statements("mt = { 1, 2 } setmetatable(mt, { __index = function() return 0 end })");
+    ASSERT(ls.exec_statements("return each(mt) ~= next").at(0).to_boolean());
+    ASSERT(ls.exec_statements("return sum(mt)").at(0).to_integer() == 3);
+    ls.check_empty_stack();
+
+    // an overridden global next is not used by each, even when it
+    // is a C function
+    ls.exec_statements("native_next = next next = function() error('called') end");
+    ASSERT(ls.exec_statements("return each(t) ~= next and each(t) == native_next").at(0).to_boolean());
+    ASSERT(ls.exec_statements("return sum(t)").at(0).to_integer() == 6);
+    ls.exec_statements("next = rawget");
+    ASSERT(ls.exec_statements("return each(t) ~= next and each(t) == native_next").at(0).to_boolean());
+    ASSERT(ls.exec_statements("return sum(t)").at(0).to_integer() == 6);
+    ls.check_empty_stack();
+  }
+
   {
     QtLua::State ls;
 
@@ -352,6 +417,95 @@ int main()
   }
 #endif
 
+  {
+    QtLua::State ls;
+
+    RouteProbe::ptr a = QTLUA_REFNEW(RouteProbe, "a", 1);
+    RouteProbe::ptr b = QTLUA_REFNEW(RouteProbe, "b", 2);
+    DispatchProxy::ptr dp = QTLUA_REFNEW(DispatchProxy);
+
+    dp->add_target(a.ptr());
+    dp->add_target(b.ptr());
+    dp->enable_route_cache();
+    ls["d"] = Value(&ls, dp);
+
+    // targets without meta_try_index use meta_contains and meta_index
+    ASSERT(ls.exec_statements("return d.b")[0].to_integer() == 2);
+    ASSERT(a->_probes == 1 && b->_probes == 1);
+
+    // cache hit, only the target which provided the entry is probed
+    ASSERT(ls.exec_statements("return d.b")[0].to_integer() == 2);
+    ASSERT(a->_probes == 1 && b->_probes == 2);
+
+    // unknown keys are not cached
+    ASSERT(ls.exec_statements("return d.c")[0].is_nil());
+    ASSERT(ls.exec_statements("return d.c")[0].is_nil());
+    ASSERT(a->_probes == 3 && b->_probes == 4);
+
+    // entry added to the first target shadows the cached route
+    a->_key = "b";
+    ASSERT(ls.exec_statements("return d.b")[0].to_integer() == 2);
+    dp->invalidate_route_cache();
+    ASSERT(ls.exec_statements("return d.b")[0].to_integer() == 1);
+    ASSERT(a->_probes == 4 && b->_probes == 5);
+
+    // removing a target drops cached routes
+    dp->remove_target(a.ptr());
+    ASSERT(ls.exec_statements("return d.b")[0].to_integer() == 2);
+    ASSERT(a->_probes == 4 && b->_probes == 6);
+
+    // entry removed from the target, cached route misses
+    b->_key = "x";
+    ASSERT(ls.exec_statements("return d.b")[0].is_nil());
+    ASSERT(b->_probes == 8);
+
+    ls.check_empty_stack();
+  }
+
+  {
+    QtLua::State ls;
+    ls.openlib(BaseLib);
+
+    typedef QHash<String, int> Hash;
+    Hash h;
+    h["a"] = 1;
+    h["b"] = 2;
+
+    QHashProxy<Hash>::ptr hp = QTLUA_REFNEW(QHashProxy<Hash>, h);
+    ls["h"] = Value(&ls, hp);
+
+    // string keys are looked up without copying the lua string
+    ASSERT(ls.exec_statements("return h.a")[0].to_integer() == 1);
+    ASSERT(ls.exec_statements("return h['a' .. 'b']")[0].is_nil());
+    ASSERT(hp->meta_contains(&ls, Value(&ls, "b")));
+    ASSERT(!hp->meta_contains(&ls, Value(&ls, "c")));
+    ASSERT(hp->meta_index(&ls, Value(&ls, String("b"))).to_integer() == 2);
+
+    // inserted keys own their content, removal works with lua keys
+    ls.exec_statements("h['c' .. 'd'] = 3 h.a = nil collectgarbage()");
+    ASSERT(h.size() == 2 && !h.contains("a"));
+    ls.gc_collect();
+    ASSERT(h.value("cd") == 3);
+    ASSERT(ls.exec_statements("return h.cd")[0].to_integer() == 3);
+
+    // dispatch proxy route cache over the same hash
+    DispatchProxy::ptr dp = QTLUA_REFNEW(DispatchProxy);
+    dp->add_target(hp.ptr());
+    dp->enable_route_cache();
+    ls["d"] = Value(&ls, dp);
+
+    ASSERT(ls.exec_statements("return d.b")[0].to_integer() == 2);
+    ASSERT(ls.exec_statements("return d['b']")[0].to_integer() == 2);
+    ls.exec_statements("d.b = nil collectgarbage()");
+    ASSERT(!h.contains("b"));
+    ASSERT(ls.exec_statements("return d.b")[0].is_nil());
+    ls.exec_statements("d['e' .. 'f'] = 4 collectgarbage()");
+    ASSERT(h.value("ef") == 4);
+    ASSERT(ls.exec_statements("return d.ef")[0].to_integer() == 4);
+
+    ls.check_empty_stack();
+  }
+
   } catch (QtLua::String &e) {
     std::cout << e.constData() << std::endl;
     ASSERT(0);
@@ -23,6 +23,16 @@
 #include <QtLua/State>
 #include <QtLua/Value>
 
+#include <QPoint>
+#include <QRect>
+#include <QColor>
+#include <QStringList>
+
+#if QT_VERSION >= 0x050000
+# include <QJsonArray>
+# include <QJsonObject>
+#endif
+
 using namespace QtLua;
 
 int main()
@@ -117,6 +127,198 @@ int main()
       ASSERT(func(num).at(0).to_number() + 1.0f < 0.001f);
     }
 
+    {
+      QtLua::State ls;
+
+      ls.openlib(MathLib);
+
+      Value::List res = ls.exec_statements("return 1234567, 1.5, math.type ~= nil");
+
+      ASSERT(res[1].to_qvariant().userType() == QMetaType::Double);
+      ASSERT(res[1].to_string_p() == "1.5");
+
+      // lua integers keep their type and are printed without exponent
+      if (res[2].to_boolean())
+	{
+	  ASSERT(res[0].to_qvariant().userType() == QMetaType::LongLong);
+	  ASSERT(res[0].to_qvariant().toLongLong() == 1234567);
+	  ASSERT(res[0].to_string_p() == "1234567");
+	}
+    }
+
+    {
+      QtLua::State ls;
+
+      ls.openlib(BaseLib);
+      ls.openlib(QtLuaLib);
+
+      ls["p"] = Value(&ls, QVariant(QPoint(1, 2)));
+      ls["r"] = Value(&ls, QVariant(QRect(1, 2, 3, 4)));
+      ls["c"] = Value(&ls, QVariant(QColor(10, 20, 30)));
+
+      // packed values are plain lua userdata with a shared metatable
+      ASSERT(ls.exec_statements("return type(p) == 'userdata' and type(c) == 'userdata' "
+				"and getmetatable(p) == getmetatable(p * 1)").at(0).to_boolean());
+      ASSERT(ls.exec_statements("return qtype(p)").at(0).to_string() == "QPoint");
+      ASSERT(ls.at("r").type_name_u() == "QRect");
+
+      ASSERT(ls.exec_statements("return #p == 2 and #r == 4 and #c == 4").at(0).to_boolean());
+      ASSERT(ls.exec_statements("return p.x == 1 and p[2] == 2 and r.height == 4 "
+				"and c.green == 20 and p.z == nil").at(0).to_boolean());
+
+      // pairs iterates over integer indexes like on the equivalent table
+      ASSERT(ls.exec_statements("local s, n = '', 0 for k, v in pairs(r) do s = s .. k .. ' ' n = n + v end "
+				"return s == '1 2 3 4 ' and n == 10").at(0).to_boolean());
+      ASSERT(ls.exec_statements("local n = 0 for k, v in each(c) do n = n + v end "
+				"return n == 315").at(0).to_boolean());
+
+      // packed values are handled by C++ generic value functions
+      ASSERT(ls.at("p").at(2).to_integer() == 2 && ls.at("r").len() == 4);
+      ASSERT(ls.at("r").to_qvariant().toRect() == QRect(1, 2, 3, 4));
+      ASSERT(ls.at("p").support(Value::OpAdd) && !ls.at("c").support(Value::OpAdd));
+
+      QVariantList pl = ls.exec_statements("return { p, r }").at(0)
+	.to_qvariant(QMetaType::QVariantList).toList();
+      ASSERT(pl.size() == 2 && pl.at(0).toPoint() == QPoint(1, 2) &&
+	     pl.at(1).toRect() == QRect(1, 2, 3, 4));
+
+      ASSERT(ls.exec_statements("q = p + p * 2 q.y = 0 return q.x == 3 and q.y == 0 "
+				"and p.y == 2 and p == -(-p) and p ~= q").at(0).to_boolean());
+
+      ASSERT(ls.at("q").to_qvariant(QMetaType::QPoint).toPoint() == QPoint(3, 0));
+      ASSERT(ls.at("c").to_qvariant(QMetaType::QColor).value<QColor>() == QColor(10, 20, 30));
+
+      bool thrown = false;
+      try {
+	ls.exec_statements("p.z = 1");
+      } catch (QtLua::String &e) {
+	thrown = true;
+      }
+      ASSERT(thrown);
+
+      thrown = false;
+      try {
+	ls.exec_statements("return c + c");
+      } catch (QtLua::String &e) {
+	thrown = true;
+      }
+      ASSERT(thrown);
+    }
+
+    {
+      QtLua::State ls;
+
+      ls.exec_statements("m = { a = 1, [2] = 'two', [true] = 3, [{}] = 4 } "
+			 "l = { 1, { 2, 3 }, 'x' } sl = { 'a', 2 } "
+			 "t = { } s = { t, t } rec = { 1 } rec[2] = { rec } "
+			 "deep = { } local d = deep for i = 1, 100 do d[1] = { } d = d[1] end");
+
+      // keys which are neither strings nor numbers are dropped
+      QVariantMap m = ls.at("m").to_qvariant(QMetaType::QVariantMap).toMap();
+      ASSERT(m.size() == 2);
+      ASSERT(m.value("a").toInt() == 1 && m.value("2").toString() == "two");
+
+      QVariantHash h = ls.at("m").to_qvariant(QMetaType::QVariantHash).toHash();
+      ASSERT(h.size() == 2 && h.contains("a") && h.contains("2"));
+
+      QVariantList l = ls.at("l").to_qvariant(QMetaType::QVariantList).toList();
+      ASSERT(l.size() == 3 && l.at(1).toList().size() == 2 && l.at(2).toString() == "x");
+
+      QStringList sl = ls.at("sl").to_qvariant(QMetaType::QStringList).toStringList();
+      ASSERT(sl.size() == 2 && sl.at(0) == "a" && sl.at(1) == "2");
+
+      // a table referenced twice is not a cycle
+      ASSERT(ls.at("s").to_qvariant(QMetaType::QVariantList).toList().size() == 2);
+
+      // recursive and too deep tables are rejected
+      bool thrown = false;
+      try {
+	ls.at("rec").to_qvariant(QMetaType::QVariantList);
+      } catch (QtLua::String &e) {
+	thrown = e.contains("recursive");
+      }
+      ASSERT(thrown);
+
+      thrown = false;
+      try {
+	ls.at("deep").to_qvariant(QMetaType::QVariantList);
+      } catch (QtLua::String &e) {
+	thrown = e.contains("deeply");
+      }
+      ASSERT(thrown);
+    }
+
+#if QT_VERSION >= 0x050000
+    {
+      QtLua::State ls;
+
+      ls.openlib(MathLib);
+      ls.exec_statements("arr = { 1, 2.5, 'x' } obj = { a = 1, b = { 2, 3 } } "
+			 "rec = { } rec.self = rec");
+      ls["pt"] = Value(&ls, QVariant(QPoint(5, 6)));
+
+      // tables with a length are arrays, others are objects
+      QJsonValue arr = ls.at("arr").to_json();
+      ASSERT(arr.isArray() && arr.toArray().size() == 3);
+      ASSERT(arr.toArray().at(1).toDouble() == 2.5);
+
+      QJsonValue obj = ls.at("obj").to_json();
+      ASSERT(obj.isObject() && obj.toObject().size() == 2);
+      ASSERT(obj.toObject().value("b").isArray());
+
+      // packed values are serialized as arrays of fields
+      QJsonValue pt = ls.exec_statements("return { pt }").at(0).to_json();
+      ASSERT(pt.toArray().at(0).toArray().at(1).toInt() == 6);
+
+      ls["arr2"] = Value::from_json(&ls, arr);
+      ls["obj2"] = Value::from_json(&ls, obj);
+      ASSERT(ls.exec_statements("return arr2[1] == 1 and arr2[2] == 2.5 and arr2[3] == 'x' "
+				"and obj2.a == 1 and obj2.b[2] == 3").at(0).to_boolean());
+      // integral numbers come back as lua integers, others as floats
+      ASSERT(ls.exec_statements("return not math.type or (math.type(arr2[1]) == 'integer' "
+				"and math.type(arr2[2]) == 'float')").at(0).to_boolean());
+
+      // out of range integral values must not overflow
+      ASSERT(Value::from_json(&ls, QJsonValue(1e19)).to_number() == 1e19);
+      ASSERT(Value::from_json(&ls, QJsonValue(-1e19)).to_number() == -1e19);
+
+      // recursive tables are rejected
+      bool thrown = false;
+      try {
+	ls.at("rec").to_json();
+      } catch (QtLua::String &e) {
+	thrown = true;
+      }
+      ASSERT(thrown);
+    }
+#endif
+
+#if QT_VERSION >= 0x050C00
+    {
+      QtLua::State ls;
+
+      ls.openlib(MathLib);
+      ls.exec_statements("arr = { 1, 2.5, 'x' } obj = { a = 1, b = { 2, 3 } } "
+			 "rec = { { } } rec[1][1] = rec");
+
+      ls["arr2"] = Value::from_cbor(&ls, ls.at("arr").to_cbor());
+      ls["obj2"] = Value::from_cbor(&ls, ls.at("obj").to_cbor());
+      ASSERT(ls.exec_statements("return #arr2 == 3 and arr2[1] == 1 and arr2[2] == 2.5 "
+				"and arr2[3] == 'x' and obj2.a == 1 and #obj2.b == 2 "
+				"and obj2.b[2] == 3").at(0).to_boolean());
+      ASSERT(ls.exec_statements("return not math.type or (math.type(arr2[1]) == 'integer' "
+				"and math.type(arr2[2]) == 'float')").at(0).to_boolean());
+
+      bool thrown = false;
+      try {
+	ls.at("rec").to_cbor();
+      } catch (QtLua::String &e) {
+	thrown = true;
+      }
+      ASSERT(thrown);
+    }
+#endif
+
   } catch (QtLua::String &e) {
     std::cout << e.constData() << std::endl;
     ASSERT(0);